@@ -976,6 +976,82 @@ fs::file::file(const void* ptr, std::size_t size)
 	m_file = std::make_unique<memory_stream>(ptr, size);
 }
 
+fs::file::file(std::vector<u8>&& buffer)
+{
+	class container_stream : public file_base
+	{
+		u64 m_pos{};
+
+		std::vector<u8> m_data;
+
+	public:
+		container_stream(std::vector<u8>&& data)
+			: m_data(std::move(data))
+		{
+		}
+
+		fs::stat_t stat() override
+		{
+			fs::stat_t info{};
+			info.is_writable = true;
+			info.size = m_data.size();
+			return info;
+		}
+
+		bool trunc(u64 length) override
+		{
+			m_data.resize(length);
+			return true;
+		}
+
+		u64 read(void* buffer, u64 count) override
+		{
+			const u64 start = std::min<u64>(m_pos, m_data.size());
+			const u64 read_size = std::min<u64>(count, m_data.size() - start);
+			std::memcpy(buffer, m_data.data() + start, read_size);
+			m_pos = start + read_size;
+			return read_size;
+		}
+
+		u64 write(const void* buffer, u64 count) override
+		{
+			// Writing past the end fills the gap with zeros
+			if (m_pos + count > m_data.size())
+			{
+				m_data.resize(m_pos + count);
+			}
+
+			std::memcpy(m_data.data() + m_pos, buffer, count);
+			m_pos += count;
+			return count;
+		}
+
+		u64 seek(s64 offset, fs::seek_mode whence) override
+		{
+			const s64 new_pos =
+				whence == fs::seek_set ? offset :
+				whence == fs::seek_cur ? offset + m_pos :
+				whence == fs::seek_end ? offset + m_data.size() :
+				(fmt::throw_exception("Invalid whence (0x%x)" HERE, whence), 0);
+
+			if (new_pos < 0)
+			{
+				fs::g_tls_error = fs::error::inval;
+				return -1;
+			}
+
+			return m_pos = new_pos;
+		}
+
+		u64 size() override
+		{
+			return m_data.size();
+		}
+	};
+
+	m_file = std::make_unique<container_stream>(std::move(buffer));
+}
+
 void fs::dir::xnull() const
 {
 	fmt::throw_exception<std::logic_error>("fs::dir is null");
@@ -167,6 +167,9 @@ namespace fs
 		// Open memory for read
 		explicit file(const void* ptr, std::size_t size);
 
+		// Open memory for read and write (the file owns the buffer)
+		explicit file(std::vector<u8>&& buffer);
+
 		// Check whether the handle is valid (opened file)
 		explicit operator bool() const
 		{
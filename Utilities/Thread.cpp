@@ -3,6 +3,7 @@
 #include "Emu/System.h"
 #include "Emu/IdManager.h"
 #include "Emu/Cell/RawSPUThread.h"
+#include "Emu/Benchmark.h"
 #include "Thread.h"
 
 #ifdef _WIN32
@@ -16,6 +17,7 @@
 #include <errno.h>
 #include <signal.h>
 #include <ucontext.h>
+#include <pthread.h>
 #endif
 
 static void report_fatal_error(const std::string& msg)
@@ -1139,11 +1141,12 @@ bool handle_access_violation(u32 addr, bool is_writing, x64_context* context)
 
 		// skip processed instruction
 		RIP(context) += i_size;
+		if (UNLIKELY(g_perf_counters.enabled)) g_perf_counters.fault_raw_spu++;
 		return true;
 	}
 
 	// check if fault is caused by the reservation
-	return vm::reservation_query(addr, (u32)a_size, is_writing, [&]() -> bool
+	const bool result = vm::reservation_query(addr, (u32)a_size, is_writing, [&]() -> bool
 	{
 		// write memory using "privileged" access to avoid breaking reservation
 		if (!d_size || !i_size)
@@ -1585,7 +1588,13 @@ bool handle_access_violation(u32 addr, bool is_writing, x64_context* context)
 		return true;
 	});
 
+	if (result)
+	{
+		if (UNLIKELY(g_perf_counters.enabled)) g_perf_counters.fault_reservation++;
+	}
+
 	// TODO: allow recovering from a page fault as a feature of PS3 virtual memory
+	return result;
 }
 
 #ifdef __linux__
@@ -2300,6 +2309,34 @@ void thread_ctrl::sleep(u64 useconds)
 	std::this_thread::sleep_for(std::chrono::microseconds(useconds));
 }
 
+void thread_ctrl::set_native_affinity(u64 mask)
+{
+#ifdef _WIN32
+	if (!SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(mask)))
+	{
+		LOG_ERROR(GENERAL, "SetThreadAffinityMask(0x%llx) failed (0x%x)", mask, GetLastError());
+	}
+#elif defined(__linux__)
+	cpu_set_t cs;
+	CPU_ZERO(&cs);
+
+	for (u32 i = 0; i < 64; i++)
+	{
+		if (mask & (1ull << i))
+		{
+			CPU_SET(i, &cs);
+		}
+	}
+
+	if (const int err = pthread_setaffinity_np(pthread_self(), sizeof(cs), &cs))
+	{
+		LOG_ERROR(GENERAL, "pthread_setaffinity_np(0x%llx) failed (%d)", mask, err);
+	}
+#else
+	// TODO (affinity is only a hint on other hosts)
+#endif
+}
+
 
 named_thread::named_thread()
 {
@@ -230,6 +230,9 @@ public:
 	// Wrapper for std::this_thread::sleep, doesn't require valid thread_ctrl.
 	[[deprecated]] static void sleep(u64 useconds);
 
+	// Restrict current thread to the specified host cores (bit mask, may be ignored by the host)
+	static void set_native_affinity(u64 mask);
+
 	// Wait until pred(). Abortable, may throw. Thread must be locked.
 	// Timeout in microseconds (zero means infinite).
 	template<typename F>
@@ -0,0 +1,94 @@
+#include "stdafx.h"
+#include "Emu/Cell/Modules/cellAudio.h"
+#include "Emu/Audio/Null/NullAudioThread.h"
+
+TEST_CLASS(cell_audio)
+{
+	// Run the mixer with a host period off by `drift` (relative) against the simulated 48 kHz playback
+	static void run_output_stage(double drift)
+	{
+		u64 now = 0;
+		NullAudioThread audio([&] { return now; });
+		audio_output_stage output(30);
+
+		std::vector<f32> in(8 * BUFFER_SIZE);
+		std::vector<f32> out(8 * audio_output_stage::max_frames);
+
+		audio.Open(in.data(), static_cast<int>(in.size() * sizeof(f32)));
+
+		const u32 periods = 20000;
+		u64 underruns = 0;
+
+		for (u32 n = 1; n <= periods; n++)
+		{
+			now = static_cast<u64>(n * 1000000.0 * AUDIO_SAMPLES / 48000 / (1.0 + drift));
+
+			const u32 frames = output.process(audio, in.data(), out.data());
+
+			audio.AddData(out.data(), static_cast<int>(frames * 8 * sizeof(f32)));
+
+			if (n == periods / 2)
+			{
+				underruns = output.underruns;
+			}
+		}
+
+		const s32 depth = audio.GetQueuedFrames();
+
+		if (output.underruns != underruns)
+		{
+			TEST_FAILURE("Underruns after convergence (drift=%f, underruns=%llu)", drift, output.underruns - underruns);
+		}
+
+		if (depth < static_cast<s32>(output.target() / 2) || depth > static_cast<s32>(output.target() * 3 / 2))
+		{
+			TEST_FAILURE("Queue depth not converged (drift=%f, depth=%d, target=%u)", drift, depth, output.target());
+		}
+
+		if (std::abs(output.ratio() - (1.0 + drift)) > 0.0005)
+		{
+			TEST_FAILURE("Ratio not converged (drift=%f, ratio=%f)", drift, output.ratio());
+		}
+
+		if (output.dropped)
+		{
+			TEST_FAILURE("Blocks dropped (drift=%f, dropped=%llu)", drift, output.dropped);
+		}
+	}
+
+	// Check that the queue depth converges to the target latency with a fast or slow host clock
+	TEST_METHOD(output_stage_drift)
+	{
+		run_output_stage(0.003);
+		run_output_stage(-0.003);
+		run_output_stage(0.0);
+	}
+
+	// Check that the target is clamped and the queue never exceeds the backend capacity
+	TEST_METHOD(output_stage_capacity)
+	{
+		const u32 capacity = 4096;
+
+		NullAudioThread audio([] { return u64{0}; }); // Playback never advances
+		audio_output_stage output(500, capacity);
+
+		Assert::AreEqual(capacity / 2, output.target());
+
+		std::vector<f32> in(8 * BUFFER_SIZE);
+		std::vector<f32> out(8 * audio_output_stage::max_frames);
+
+		for (u32 n = 0; n < 100; n++)
+		{
+			const u32 frames = output.process(audio, in.data(), out.data());
+
+			audio.AddData(out.data(), static_cast<int>(frames * 8 * sizeof(f32)));
+
+			if (audio.GetQueuedFrames() > static_cast<s32>(capacity))
+			{
+				TEST_FAILURE("Capacity exceeded (period=%u, depth=%d)", n, audio.GetQueuedFrames());
+			}
+		}
+
+		Assert::IsTrue(output.dropped > 0);
+	}
+};
@@ -0,0 +1,124 @@
+#include "stdafx.h"
+#include "Emu/IdManager.h"
+
+#include <chrono>
+#include <map>
+#include <thread>
+
+// Syscall-like lookups: lock-free idm::get/idm::check against the reader lock path
+TEST_CLASS(id_manager_bench)
+{
+	struct test_object
+	{
+		static const u32 id_base = 0x1000;
+		static const u32 id_step = 0x100;
+		static const u32 id_count = 8192;
+
+		u32 value;
+
+		test_object(u32 value)
+			: value(value)
+		{
+		}
+	};
+
+	static const u32 s_objects = 256;
+	static const u32 s_lookups = 1000000;
+
+	// Run func(id) for s_lookups IDs on each thread, return ns per lookup
+	template<typename F>
+	static double measure(const char* name, const std::vector<u32>& ids, u32 threads, F func)
+	{
+		std::vector<std::thread> workers;
+		atomic_t<u32> failed{0};
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (u32 t = 0; t < threads; t++)
+		{
+			workers.emplace_back([&]
+			{
+				for (u32 i = 0; i < s_lookups; i++)
+				{
+					if (!func(ids[i % ids.size()])) failed++;
+				}
+			});
+		}
+
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+
+		const auto time = std::chrono::steady_clock::now() - start;
+
+		if (failed)
+		{
+			TEST_FAILURE("%s: %u lookups failed", name, failed.load());
+		}
+
+		return std::chrono::duration<double, std::nano>(time).count() / s_lookups;
+	}
+
+	TEST_METHOD(lookup)
+	{
+		idm::init();
+
+		std::vector<u32> ids;
+
+		// Previous implementation: tree under the global reader lock
+		std::map<u32, std::shared_ptr<void>> map;
+
+		for (u32 i = 0; i < s_objects; i++)
+		{
+			const u32 id = idm::make<test_object>(i);
+			ids.push_back(id);
+			map.emplace(id, idm::get<test_object>(id));
+		}
+
+		for (u32 threads : {1, 4})
+		{
+			const double get = measure("idm::get", ids, threads, [](u32 id)
+			{
+				return idm::get<test_object>(id) != nullptr;
+			});
+
+			const double check = measure("idm::check", ids, threads, [](u32 id)
+			{
+				return !!idm::check<test_object>(id);
+			});
+
+			const double locked = measure("idm::check(func)", ids, threads, [](u32 id)
+			{
+				return !!idm::check<test_object>(id, [](test_object&) {});
+			});
+
+			const double locked_get = measure("idm::get(func)", ids, threads, [](u32 id)
+			{
+				return idm::get<test_object>(id, [](test_object&) {}) != nullptr;
+			});
+
+			const double tree = measure("std::map", ids, threads, [&](u32 id)
+			{
+				reader_lock lock(id_manager::g_mutex);
+
+				const auto found = map.find(id);
+				return found != map.end() && std::shared_ptr<void>(found->second) != nullptr;
+			});
+
+			TEST_LOG("%u thread(s), ns per lookup: get=%.1f check=%.1f check(func)=%.1f get(func)=%.1f map+lock=%.1f\n", threads, get, check, locked, locked_get, tree);
+		}
+
+		// Removed IDs must not be found by lock-free lookups
+		for (u32 id : ids)
+		{
+			if (!idm::remove<test_object>(id) || idm::get<test_object>(id) || idm::check<test_object>(id))
+			{
+				TEST_FAILURE("ID not removed (id=0x%x)", id);
+			}
+		}
+
+		map.clear();
+		idm::clear();
+	}
+};
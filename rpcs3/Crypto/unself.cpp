@@ -3,10 +3,16 @@
 #include "sha1.h"
 #include "utils.h"
 #include "unself.h"
+#include "Utilities/Config.h"
+#include "Utilities/Thread.h"
 
 // TODO: Still reliant on wxWidgets for zlib functions. Alternative solutions?
 #include <zlib.h>
 
+#include <thread>
+
+cfg::bool_entry g_cfg_self_cache(cfg::root.core, "Cache decrypted executables");
+
 inline u8 Read8(const fs::file& f)
 {
 	u8 ret;
@@ -1048,6 +1054,11 @@ bool SELFDecrypter::MakeElf(const std::string& elf, bool isElf32)
 		return false;
 	}
 
+	return MakeElf(e, isElf32);
+}
+
+bool SELFDecrypter::MakeElf(const fs::file& e, bool isElf32)
+{
 	// Set initial offset.
 	u32 data_buf_offset = 0;
 
@@ -1098,55 +1109,87 @@ bool SELFDecrypter::MakeElf(const std::string& elf, bool isElf32)
 			WritePhdr(e, phdr64_arr[i]);
 		}
 
+		// Locate the data of each section and decompress the compressed ones (in parallel, they are independent).
+		std::vector<u32> data_offsets(meta_hdr.section_count);
+		std::vector<u32> compressed;
+
+		for (unsigned int i = 0; i < meta_hdr.section_count; i++)
+		{
+			data_offsets[i] = data_buf_offset;
+
+			// PHDR type.
+			if (meta_shdr[i].type == 2)
+			{
+				if (meta_shdr[i].compressed == 2)
+				{
+					compressed.push_back(i);
+				}
+
+				// Advance the data buffer offset by data size.
+				data_buf_offset += meta_shdr[i].data_size;
+			}
+		}
+
+		std::vector<std::unique_ptr<u8[]>> decomp_bufs(meta_hdr.section_count);
+		atomic_t<u32> next_section{0};
+
+		auto inflate_sections = [&]()
+		{
+			for (u32 index; (index = next_section++) < compressed.size();)
+			{
+				const u32 i = compressed[index];
+
+				// decomp_buf_length changes inside the call to uncompress, so it must be of the correct type.
+				uLongf decomp_buf_length = static_cast<uLongf>(phdr64_arr[meta_shdr[i].program_idx].p_filesz);
+				decomp_bufs[i].reset(new u8[phdr64_arr[meta_shdr[i].program_idx].p_filesz]);
+
+				// Use zlib uncompress directly on the decrypted data (it is not modified).
+				int rv = uncompress(decomp_bufs[i].get(), &decomp_buf_length, data_buf.get() + data_offsets[i], data_buf_length - data_offsets[i]);
+
+				// Check for errors (TODO: Probably safe to remove this once these changes have passed testing.)
+				switch (rv)
+				{
+				case Z_MEM_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_MEM_ERROR!"); break;
+				case Z_BUF_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_BUF_ERROR!"); break;
+				case Z_DATA_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_DATA_ERROR!"); break;
+				default: break;
+				}
+			}
+		};
+
+		// The current thread takes part in decompression.
+		const u32 thread_count = std::min<u32>(std::max<u32>(std::thread::hardware_concurrency(), 1), ::size32(compressed));
+		std::vector<std::shared_ptr<thread_ctrl>> threads(thread_count > 1 ? thread_count - 1 : 0);
+
+		for (auto& thread : threads)
+		{
+			thread_ctrl::spawn(thread, "SELF Decompression", inflate_sections);
+		}
+
+		inflate_sections();
+
+		for (auto& thread : threads)
+		{
+			thread->join();
+		}
+
 		// Write data.
 		for (unsigned int i = 0; i < meta_hdr.section_count; i++)
 		{
 			// PHDR type.
 			if (meta_shdr[i].type == 2)
 			{
-				// Decompress if necessary.
+				// Seek to the program header data offset and write the data.
+				e.seek(phdr64_arr[meta_shdr[i].program_idx].p_offset);
+
 				if (meta_shdr[i].compressed == 2)
 				{
-					/// Removed all wxWidget dependent code. Replaced with zlib functions.
-					/// Also changed local mallocs to unique_ptrs.
-
-					// Store the length in writeable memory space.
-					std::unique_ptr<uLongf> decomp_buf_length(new uLongf);
-					memcpy(decomp_buf_length.get(), &phdr64_arr[meta_shdr[i].program_idx].p_filesz, sizeof(uLongf));
-
-					/// Create a pointer to a buffer for decompression.
-					std::unique_ptr<u8[]> decomp_buf(new u8[phdr64_arr[meta_shdr[i].program_idx].p_filesz]);
-
-					// Create a buffer separate from data_buf to uncompress.
-					std::unique_ptr<u8[]> zlib_buf(new u8[data_buf_length]);
-					memcpy(zlib_buf.get(), data_buf.get(), data_buf_length);
-
-					// Use zlib uncompress on the new buffer.
-					// decomp_buf_length changes inside the call to uncompress, so it must be a pointer to correct type (in writeable mem space).
-					int rv = uncompress(decomp_buf.get(), decomp_buf_length.get(), zlib_buf.get() + data_buf_offset, data_buf_length);
-
-					// Check for errors (TODO: Probably safe to remove this once these changes have passed testing.)
-					switch (rv)
-					{
-					case Z_MEM_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_MEM_ERROR!"); break;
-					case Z_BUF_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_BUF_ERROR!"); break;
-					case Z_DATA_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_DATA_ERROR!"); break;
-					default: break;
-					}
-
-					// Seek to the program header data offset and write the data.
-					e.seek(phdr64_arr[meta_shdr[i].program_idx].p_offset);
-					e.write(decomp_buf.get(), phdr64_arr[meta_shdr[i].program_idx].p_filesz);
+					e.write(decomp_bufs[i].get(), phdr64_arr[meta_shdr[i].program_idx].p_filesz);
 				}
 				else
 				{
-					// Seek to the program header data offset and write the data.
-					e.seek(phdr64_arr[meta_shdr[i].program_idx].p_offset);
-					e.write(data_buf.get() + data_buf_offset, meta_shdr[i].data_size);
+					e.write(data_buf.get() + data_offsets[i], meta_shdr[i].data_size);
 				}
-
-				// Advance the data buffer offset by data size.
-				data_buf_offset += meta_shdr[i].data_size;
 			}
 		}
 
@@ -1213,17 +1256,14 @@ bool IsSelf(const std::string& path)
 	return hdr.CheckMagic();
 }
 
-bool IsSelfElf32(const std::string& path)
+static bool IsSelfElf32(const fs::file& f)
 {
-	fs::file f(path);
-
-	if (!f) return false;
-
 	SceHeader hdr;
 	SelfHeader sh;
+	f.seek(0);
 	hdr.Load(f);
 	sh.Load(f);
-	
+
 	// Locate the class byte and check it.
 	u8 elf_class[0x8];
 
@@ -1233,6 +1273,15 @@ bool IsSelfElf32(const std::string& path)
 	return (elf_class[4] == 1);
 }
 
+bool IsSelfElf32(const std::string& path)
+{
+	fs::file f(path);
+
+	if (!f) return false;
+
+	return IsSelfElf32(f);
+}
+
 bool CheckDebugSelf(const std::string& self, const std::string& elf)
 {
 	// Open the SELF file.
@@ -1292,49 +1341,164 @@ bool DecryptSelf(const std::string& elf, const std::string& self)
 {
 	LOG_NOTICE(LOADER, "Decrypting %s", self);
 
-	// Check for a debug SELF first.
-	if (!CheckDebugSelf(self, elf))
+	const fs::file e = decrypt_self(fs::file(self));
+
+	if (!e)
 	{
-		// Set a virtual pointer to the SELF file.
-		fs::file self_vf(self);
+		return false;
+	}
 
-		if (!self_vf)
-			return false;
+	// Write the ELF file.
+	fs::file out(elf, fs::rewrite);
+	if (!out)
+	{
+		LOG_ERROR(LOADER, "Could not create ELF file! (%s)", elf.c_str());
+		return false;
+	}
 
-		// Check the ELF file class (32 or 64 bit).
-		bool isElf32 = IsSelfElf32(self);
+	char buf[0x10000];
+	while (u64 size = e.read(buf, sizeof(buf)))
+	{
+		out.write(buf, size);
+	}
 
-		// Start the decrypter on this SELF file.
-		SELFDecrypter self_dec(self_vf);
+	return true;
+}
 
-		// Load the SELF file headers.
-		if (!self_dec.LoadHeaders(isElf32))
-		{
-			LOG_ERROR(LOADER, "SELF: Failed to load SELF file headers!");
-			return false;
-		}
-		
-		// Load and decrypt the SELF file metadata.
-		if (!self_dec.LoadMetadata())
-		{
-			LOG_ERROR(LOADER, "SELF: Failed to load SELF file metadata!");
-			return false;
-		}
-		
-		// Decrypt the SELF file data.
-		if (!self_dec.DecryptData())
+// Copy the remaining file contents.
+static void copy_contents(const fs::file& from, const fs::file& to)
+{
+	std::vector<u8> buf(0x100000);
+
+	while (u64 size = from.read(buf.data(), buf.size()))
+	{
+		to.write(buf.data(), size);
+	}
+}
+
+// Cache file of the decrypted SELF, named by the hash of its contents.
+static std::string get_self_cache_path(const fs::file& self)
+{
+	sha1_context ctx;
+	sha1_starts(&ctx);
+
+	std::vector<u8> buf(0x100000);
+	self.seek(0);
+
+	while (u64 size = self.read(buf.data(), buf.size()))
+	{
+		sha1_update(&ctx, buf.data(), size);
+	}
+
+	u8 hash[20];
+	sha1_finish(&ctx, hash);
+
+	std::string name;
+
+	for (u8 byte : hash)
+	{
+		fmt::append(name, "%02x", byte);
+	}
+
+	return fs::get_config_dir() + "data/self/" + name + ".elf";
+}
+
+fs::file decrypt_self(fs::file elf_or_self)
+{
+	if (!elf_or_self)
+	{
+		return{};
+	}
+
+	elf_or_self.seek(0);
+
+	SceHeader sce_hdr;
+	sce_hdr.Load(elf_or_self);
+
+	// Not a SELF file.
+	if (!sce_hdr.CheckMagic())
+	{
+		elf_or_self.seek(0);
+		return elf_or_self;
+	}
+
+	// Check for a debug SELF (the key version is 0x8000, the real ELF follows the header).
+	if (sce_hdr.se_flags == 0x8000)
+	{
+		LOG_WARNING(LOADER, "Debug SELF detected! Removing fake header...");
+
+		fs::file e(std::vector<u8>{});
+		elf_or_self.seek(sce_hdr.se_hsize);
+		copy_contents(elf_or_self, e);
+		e.seek(0);
+		return e;
+	}
+
+	std::string cache_path;
+
+	if (g_cfg_self_cache)
+	{
+		cache_path = get_self_cache_path(elf_or_self);
+
+		if (fs::file cached{cache_path})
 		{
-			LOG_ERROR(LOADER, "SELF: Failed to decrypt SELF file data!");
-			return false;
+			LOG_NOTICE(LOADER, "SELF: Using decrypted file from cache (%s)", cache_path);
+			return cached;
 		}
-		
-		// Make a new ELF file from this SELF.
-		if (!self_dec.MakeElf(elf, isElf32))
+	}
+
+	// Check the ELF file class (32 or 64 bit).
+	const bool isElf32 = IsSelfElf32(elf_or_self);
+
+	// Start the decrypter on this SELF file.
+	SELFDecrypter self_dec(elf_or_self);
+
+	// Load the SELF file headers.
+	if (!self_dec.LoadHeaders(isElf32))
+	{
+		LOG_ERROR(LOADER, "SELF: Failed to load SELF file headers!");
+		return{};
+	}
+
+	// Load and decrypt the SELF file metadata.
+	if (!self_dec.LoadMetadata())
+	{
+		LOG_ERROR(LOADER, "SELF: Failed to load SELF file metadata!");
+		return{};
+	}
+
+	// Decrypt the SELF file data.
+	if (!self_dec.DecryptData())
+	{
+		LOG_ERROR(LOADER, "SELF: Failed to decrypt SELF file data!");
+		return{};
+	}
+
+	// Make a new ELF file in memory from this SELF.
+	fs::file e(std::vector<u8>{});
+
+	if (!self_dec.MakeElf(e, isElf32))
+	{
+		LOG_ERROR(LOADER, "SELF: Failed to make ELF file from SELF!");
+		return{};
+	}
+
+	// Store the decrypted file (written to a temporary file first, so an interrupted write isn't used).
+	if (!cache_path.empty() && fs::create_path(fs::get_parent_dir(cache_path)))
+	{
+		if (fs::file out{cache_path + ".tmp", fs::rewrite})
 		{
-			LOG_ERROR(LOADER, "SELF: Failed to make ELF file from SELF!");
-			return false;
+			e.seek(0);
+			copy_contents(e, out);
+			out.close();
+
+			if (!fs::rename(cache_path + ".tmp", cache_path))
+			{
+				LOG_ERROR(LOADER, "SELF: Failed to store decrypted file in cache (%s)", cache_path);
+			}
 		}
 	}
 
-	return true;
+	e.seek(0);
+	return e;
 }
@@ -380,6 +380,7 @@ class SELFDecrypter
 public:
 	SELFDecrypter(const fs::file& s);
 	bool MakeElf(const std::string& elf, bool isElf32);
+	bool MakeElf(const fs::file& elf, bool isElf32);
 	bool LoadHeaders(bool isElf32);
 	void ShowHeaders(bool isElf32);
 	bool LoadMetadata();
@@ -392,3 +393,6 @@ extern bool IsSelf(const std::string& path);
 extern bool IsSelfElf32(const std::string& path);
 extern bool CheckDebugSelf(const std::string& self, const std::string& elf);
 extern bool DecryptSelf(const std::string& elf, const std::string& self);
+
+// Decrypt SELF file to in-memory ELF file (returns the file itself if it's not a SELF, or null file on failure)
+extern fs::file decrypt_self(fs::file elf_or_self);
@@ -135,7 +135,8 @@ void OpenALThread::AddData(const void* src, int size)
 		alSourceUnqueueBuffers(m_source, 1, &buffer);
 		checkForAlError("alSourceUnqueueBuffers");
 
-		int bsize = size < m_buffer_size ? size : m_buffer_size;
+		// Blocks may be slightly larger than m_buffer_size (adaptive buffering)
+		int bsize = size < m_buffer_size + m_buffer_size / 16 ? size : m_buffer_size;
 
 		alBufferData(buffer, g_cfg_audio_convert_to_u16 ? AL_FORMAT_71CHN16 : AL_FORMAT_71CHN32, bsrc, bsize, 48000);
 		checkForAlError("alBufferData");
@@ -149,3 +150,22 @@ void OpenALThread::AddData(const void* src, int size)
 
 	Play();
 }
+
+int OpenALThread::GetQueuedFrames()
+{
+	ALint queued, processed;
+
+	alGetSourcei(m_source, AL_BUFFERS_QUEUED, &queued);
+	checkForAlError("OpenALThread::GetQueuedFrames -> alGetSourcei");
+
+	alGetSourcei(m_source, AL_BUFFERS_PROCESSED, &processed);
+	checkForAlError("OpenALThread::GetQueuedFrames -> alGetSourcei");
+
+	// Approximation: buffers have the size of the block
+	return (queued - processed) * m_buffer_size / (8 * (g_cfg_audio_convert_to_u16 ? sizeof(u16) : sizeof(float)));
+}
+
+int OpenALThread::GetMaxQueuedFrames()
+{
+	return g_al_buffers_count * m_buffer_size / (8 * (g_cfg_audio_convert_to_u16 ? sizeof(u16) : sizeof(float)));
+}
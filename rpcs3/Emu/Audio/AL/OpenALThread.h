@@ -21,4 +21,6 @@ public:
 	virtual void Close() override;
 	virtual void Stop() override;
 	virtual void AddData(const void* src, int size) override;
+	virtual int GetQueuedFrames() override;
+	virtual int GetMaxQueuedFrames() override;
 };
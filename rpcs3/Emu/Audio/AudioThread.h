@@ -10,4 +10,10 @@ public:
 	virtual void Close() = 0;
 	virtual void Stop() = 0;
 	virtual void AddData(const void* src, int size) = 0;
+
+	// Get the amount of frames waiting for playback (-1 if unknown)
+	virtual int GetQueuedFrames() { return -1; }
+
+	// Get the max amount of frames the backend can queue (0 if unlimited)
+	virtual int GetMaxQueuedFrames() { return 0; }
 };
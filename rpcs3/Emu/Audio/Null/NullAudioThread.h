@@ -1,18 +1,52 @@
 #pragma once
 
+#include "Utilities/Config.h"
 #include "Emu/Audio/AudioThread.h"
 
+#include <functional>
+
+extern cfg::bool_entry g_cfg_audio_convert_to_u16;
+extern u64 get_system_time();
+
+// Discards the data, simulates playback at 48 kHz
 class NullAudioThread : public AudioThread
 {
+	const std::function<u64()> m_clock; // Time source (us)
+
+	u64 m_start = 0; // Playback start time
+	u64 m_frames = 0; // Frames added since the start
+
+	u64 get_played() const
+	{
+		return std::min<u64>((m_clock() - m_start) * 48000 / 1000000, m_frames);
+	}
+
+	void add(int size)
+	{
+		// Restart playback after underrun
+		if (get_played() >= m_frames)
+		{
+			m_start = m_clock();
+			m_frames = 0;
+		}
+
+		m_frames += size / (8 * (g_cfg_audio_convert_to_u16 ? sizeof(u16) : sizeof(float)));
+	}
+
 public:
-	NullAudioThread() {}
+	NullAudioThread(std::function<u64()> clock = get_system_time)
+		: m_clock(std::move(clock))
+	{
+	}
+
 	virtual ~NullAudioThread() {}
 
 	virtual void Init() {}
 	virtual void Quit() {}
 	virtual void Play() {}
-	virtual void Open(const void* src, int size) {}
+	virtual void Open(const void* src, int size) { add(size); }
 	virtual void Close() {}
 	virtual void Stop() {}
-	virtual void AddData(const void* src, int size) {}
+	virtual void AddData(const void* src, int size) { add(size); }
+	virtual int GetQueuedFrames() { return static_cast<int>(m_frames - get_played()); }
 };
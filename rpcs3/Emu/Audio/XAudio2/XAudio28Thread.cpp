@@ -134,11 +134,11 @@ void XAudio2Thread::xa28_add(const void* src, int size)
 	XAUDIO2_VOICE_STATE state;
 	s_tls_source_voice->GetState(&state);
 
-	if (state.BuffersQueued > 32)
+	// Reject the buffer: the source data of queued buffers must stay valid
+	if (state.BuffersQueued >= max_buffers)
 	{
 		LOG_WARNING(GENERAL, "XAudio2Thread : too many buffers enqueued (%d, pos=%u)", state.BuffersQueued, state.SamplesPlayed);
-
-		return xa28_flush();
+		return;
 	}
 
 	XAUDIO2_BUFFER buffer;
@@ -151,7 +151,7 @@ void XAudio2Thread::xa28_add(const void* src, int size)
 	buffer.pAudioData = (const BYTE*)src;
 	buffer.pContext = 0;
 	buffer.PlayBegin = 0;
-	buffer.PlayLength = 256;
+	buffer.PlayLength = size / (8 * (g_cfg_audio_convert_to_u16 ? sizeof(u16) : sizeof(float))); // Variable with adaptive buffering
 
 	HRESULT hr = s_tls_source_voice->SubmitSourceBuffer(&buffer);
 	if (FAILED(hr))
@@ -161,4 +161,13 @@ void XAudio2Thread::xa28_add(const void* src, int size)
 	}
 }
 
+int XAudio2Thread::xa28_queued()
+{
+	XAUDIO2_VOICE_STATE state;
+	s_tls_source_voice->GetState(&state);
+
+	// Approximation: buffers contain 256 frames
+	return state.BuffersQueued * 256;
+}
+
 #endif
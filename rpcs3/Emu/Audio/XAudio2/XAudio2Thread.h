@@ -6,6 +6,11 @@
 
 class XAudio2Thread : public AudioThread
 {
+public:
+	// Max amount of queued buffers (cellAudio keeps BUFFER_NUM + 1 output buffers alive)
+	static const u32 max_buffers = 32;
+
+private:
 	struct vtable
 	{
 		void(*destroy)();
@@ -14,6 +19,7 @@ class XAudio2Thread : public AudioThread
 		void(*stop)();
 		void(*open)();
 		void(*add)(const void*, int);
+		int(*queued)();
 	};
 
 	vtable m_funcs;
@@ -25,6 +31,7 @@ class XAudio2Thread : public AudioThread
 	static void xa27_stop();
 	static void xa27_open();
 	static void xa27_add(const void*, int);
+	static int xa27_queued();
 
 	static void xa28_init(void*);
 	static void xa28_destroy();
@@ -33,6 +40,7 @@ class XAudio2Thread : public AudioThread
 	static void xa28_stop();
 	static void xa28_open();
 	static void xa28_add(const void*, int);
+	static int xa28_queued();
 
 public:
 	XAudio2Thread();
@@ -43,6 +51,8 @@ public:
 	virtual void Close() override;
 	virtual void Stop() override;
 	virtual void AddData(const void* src, int size) override;
+	virtual int GetQueuedFrames() override;
+	virtual int GetMaxQueuedFrames() override;
 };
 
 #endif
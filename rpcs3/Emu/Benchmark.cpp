@@ -0,0 +1,97 @@
+#include "stdafx.h"
+#include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
+#include "Emu/IdManager.h"
+#include "Benchmark.h"
+
+#include "Emu/Cell/SPUThread.h"
+#include "Emu/Cell/RawSPUThread.h"
+
+#include <thread>
+
+extern u64 get_system_time();
+
+perf_counters g_perf_counters;
+
+void benchmark_thread::on_task()
+{
+	const u64 start_time = get_system_time();
+	const u64 start_flips = g_perf_counters.rsx_flips;
+	const u64 start_syscalls = g_perf_counters.ppu_syscalls;
+	const u64 start_hle_calls = g_perf_counters.ppu_hle_calls;
+	const u64 start_methods = g_perf_counters.rsx_methods;
+
+	while (fxm::check<benchmark_thread>() && !Emu.IsStopped())
+	{
+		const u64 elapsed = get_system_time() - start_time;
+
+		if ((m_max_time && elapsed >= m_max_time) || (m_max_frames && g_perf_counters.rsx_flips - start_flips >= m_max_frames))
+		{
+			break;
+		}
+
+		std::this_thread::sleep_for(10ms);
+	}
+
+	const u64 elapsed = get_system_time() - start_time;
+	const double seconds = elapsed / 1000000.;
+
+	// Sum per-thread counters
+	u64 spu_blocks = 0;
+
+	idm::select<SPUThread, RawSPUThread>([&](u32, SPUThread& spu)
+	{
+		spu_blocks += spu.block_counter;
+	});
+
+	const u64 frames = g_perf_counters.rsx_flips - start_flips;
+	const u64 syscalls = g_perf_counters.ppu_syscalls - start_syscalls;
+	const u64 hle_calls = g_perf_counters.ppu_hle_calls - start_hle_calls;
+	const u64 methods = g_perf_counters.rsx_methods - start_methods;
+
+	std::string result = "{\n";
+	fmt::append(result, "\t\"title_id\": \"%s\",\n", Emu.GetTitleID());
+	fmt::append(result, "\t\"elapsed_us\": %llu,\n", elapsed);
+	fmt::append(result, "\t\"frames\": %llu,\n", frames);
+	fmt::append(result, "\t\"fps\": %.3f,\n", frames / seconds);
+	fmt::append(result, "\t\"ppu_syscalls\": %llu,\n", syscalls);
+	fmt::append(result, "\t\"ppu_syscalls_per_sec\": %.3f,\n", syscalls / seconds);
+	fmt::append(result, "\t\"ppu_hle_calls\": %llu,\n", hle_calls);
+	fmt::append(result, "\t\"ppu_hle_calls_per_sec\": %.3f,\n", hle_calls / seconds);
+	fmt::append(result, "\t\"spu_blocks\": %llu,\n", spu_blocks);
+	fmt::append(result, "\t\"rsx_methods\": %llu,\n", methods);
+	fmt::append(result, "\t\"rsx_methods_per_sec\": %.3f,\n", methods / seconds);
+	fmt::append(result, "\t\"reservation_success\": %llu,\n", g_perf_counters.reservation_success.load());
+	fmt::append(result, "\t\"reservation_failure\": %llu,\n", g_perf_counters.reservation_failure.load());
+	fmt::append(result, "\t\"fault_reservation\": %llu,\n", g_perf_counters.fault_reservation.load());
+	fmt::append(result, "\t\"fault_rsx_texture\": %llu,\n", g_perf_counters.fault_rsx_texture.load());
+	fmt::append(result, "\t\"fault_rsx_upload\": %llu,\n", g_perf_counters.fault_rsx_upload.load());
+	fmt::append(result, "\t\"fault_raw_spu\": %llu,\n", g_perf_counters.fault_raw_spu.load());
+	fmt::append(result, "\t\"raw_spu_mmio\": %llu,\n", g_perf_counters.raw_spu_mmio.load());
+	fmt::append(result, "\t\"audio_periods\": %llu,\n", g_perf_counters.audio_periods.load());
+	fmt::append(result, "\t\"audio_late_periods\": %llu,\n", g_perf_counters.audio_late_periods.load());
+	fmt::append(result, "\t\"audio_mix_ms\": %.3f,\n", g_perf_counters.audio_mix_time / 1000.);
+	fmt::append(result, "\t\"audio_underruns\": %llu,\n", g_perf_counters.audio_underruns.load());
+	fmt::append(result, "\t\"audio_overruns\": %llu,\n", g_perf_counters.audio_overruns.load());
+	fmt::append(result, "\t\"ppu_compile_ms\": %.3f,\n", g_perf_counters.ppu_compile_time / 1000.);
+	fmt::append(result, "\t\"spu_compile_ms\": %.3f,\n", g_perf_counters.spu_compile_time / 1000.);
+	fmt::append(result, "\t\"spu_compiled\": %llu,\n", g_perf_counters.spu_compiled.load());
+	fmt::append(result, "\t\"spu_guest_size\": %llu,\n", g_perf_counters.spu_guest_size.load());
+	fmt::append(result, "\t\"spu_host_size\": %llu\n", g_perf_counters.spu_host_size.load());
+	result += "}\n";
+
+	if (fs::file file{m_path, fs::rewrite})
+	{
+		file.write(result);
+		LOG_SUCCESS(GENERAL, "Benchmark finished (%u frames in %.3f s), results written to %s", frames, seconds, m_path);
+	}
+	else
+	{
+		LOG_ERROR(GENERAL, "Benchmark: failed to open %s", m_path);
+	}
+
+	Emu.CallAfter([]()
+	{
+		Emu.Stop();
+	});
+}
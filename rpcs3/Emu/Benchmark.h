@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Utilities/Atomic.h"
+#include "Utilities/Thread.h"
+
+// Host-side performance counters (only updated on slow paths, or if enabled)
+struct perf_counters
+{
+	// Enables counters updated on hot paths (benchmark mode), set before the emulation starts
+	bool enabled = false;
+
+	atomic_t<u64> ppu_syscalls{0}; // Syscalls executed via ppu_execute_syscall (if enabled)
+	atomic_t<u64> ppu_hle_calls{0}; // HLE functions executed via ppu_execute_function (if enabled)
+	atomic_t<u64> ppu_compile_time{0}; // PPU LLVM compilation time (us)
+	atomic_t<u64> spu_compile_time{0}; // SPU recompiler compilation time (us)
+	atomic_t<u64> spu_compiled{0}; // SPU functions compiled
+	atomic_t<u64> spu_guest_size{0}; // SPU code compiled (bytes)
+	atomic_t<u64> spu_host_size{0}; // SPU recompiler output (bytes)
+	atomic_t<u64> rsx_methods{0}; // RSX methods processed (if enabled)
+	atomic_t<u64> rsx_flips{0}; // RSX flips (frames)
+	atomic_t<u64> reservation_success{0}; // vm::reservation_update succeeded (if enabled)
+	atomic_t<u64> reservation_failure{0}; // vm::reservation_update failed (if enabled)
+	atomic_t<u64> fault_reservation{0}; // Access violations handled by the reservation (if enabled)
+	atomic_t<u64> fault_rsx_texture{0}; // Access violations handled by the texture cache (if enabled)
+	atomic_t<u64> fault_rsx_upload{0}; // Access violations handled by the vertex upload cache (if enabled)
+	atomic_t<u64> fault_raw_spu{0}; // RawSPU MMIO accesses handled as access violations (if enabled)
+	atomic_t<u64> raw_spu_mmio{0}; // RawSPU MMIO accesses handled without access violation (if enabled)
+	atomic_t<u64> audio_periods{0}; // cellAudio mixer periods
+	atomic_t<u64> audio_late_periods{0}; // cellAudio mixer periods started more than a period late
+	atomic_t<u64> audio_mix_time{0}; // cellAudio mixing time (us)
+	atomic_t<u64> audio_underruns{0}; // Audio backend queue found empty (adaptive buffering)
+	atomic_t<u64> audio_overruns{0}; // Audio backend queue above twice the target latency (adaptive buffering)
+};
+
+extern perf_counters g_perf_counters;
+
+// Benchmark runner: stops the emulation after the specified time or amount of frames and writes the results as JSON
+class benchmark_thread final : public named_thread
+{
+	const u64 m_max_time; // Time limit (us), 0 if unlimited
+	const u64 m_max_frames; // Frame limit, 0 if unlimited
+	const std::string m_path; // Output file
+
+	void on_task() override;
+
+	std::string get_name() const override { return "Benchmark Thread"; }
+
+public:
+	benchmark_thread(u64 max_time, u64 max_frames, const std::string& path)
+		: m_max_time(max_time)
+		, m_max_frames(max_frames)
+		, m_path(path)
+	{
+	}
+};
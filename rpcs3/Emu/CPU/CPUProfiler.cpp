@@ -0,0 +1,173 @@
+#include "stdafx.h"
+#include "Utilities/Config.h"
+#include "Emu/System.h"
+#include "Emu/IdManager.h"
+#include "CPUProfiler.h"
+
+#include "Emu/Cell/PPUThread.h"
+#include "Emu/Cell/PPUAnalyser.h"
+#include "Emu/Cell/SPUThread.h"
+#include "Emu/Cell/RawSPUThread.h"
+#include "Emu/Cell/SPUAnalyser.h"
+#include "Emu/Cell/lv2/sys_prx.h"
+
+#include <thread>
+
+cfg::int_entry<50, 100000> g_cfg_profiler_interval(cfg::root.misc, "Profiler sampling interval (us)", 1000);
+
+void cpu_profiler::on_task()
+{
+	while (fxm::check<cpu_profiler>() && !Emu.IsStopped())
+	{
+		if (Emu.IsPaused())
+		{
+			std::this_thread::sleep_for(1ms);
+			continue;
+		}
+
+		const auto sample = [&](cpu_thread& cpu, u32 pc, const char* hle)
+		{
+			if (test(cpu.state, cpu_state_pause + cpu_flag::stop + cpu_flag::exit))
+			{
+				return;
+			}
+
+			auto& data = m_threads[cpu.id];
+
+			if (data.name.empty())
+			{
+				data.name = cpu.get_name();
+				data.type = cpu.id_type();
+			}
+
+			data.counts[{pc, hle}]++;
+		};
+
+		// Note: PPU LLVM code doesn't update cia, only HLE functions are visible in that case
+		idm::select<ppu_thread>([&](u32, ppu_thread& ppu)
+		{
+			sample(ppu, ppu.cia, ppu.last_function);
+		});
+
+		idm::select<SPUThread, RawSPUThread>([&](u32, SPUThread& spu)
+		{
+			sample(spu, spu.pc, nullptr);
+		});
+
+		m_ticks++;
+
+		std::this_thread::sleep_for(std::chrono::microseconds(g_cfg_profiler_interval));
+	}
+}
+
+void cpu_profiler::on_exit()
+{
+	// Collect PPU function ranges (main executable and loaded PRX)
+	std::map<u32, u32> ppu_funcs;
+
+	if (const auto funcs = fxm::get<std::vector<ppu_function>>())
+	{
+		for (const auto& func : *funcs)
+		{
+			ppu_funcs.emplace(func.addr, func.size);
+		}
+	}
+
+	idm::select<lv2_prx_t>([&](u32, lv2_prx_t& prx)
+	{
+		for (const auto& func : prx.funcs)
+		{
+			ppu_funcs.emplace(func.addr, func.size);
+		}
+	});
+
+	const auto spu_db = fxm::get<SPUDatabase>();
+
+	// Get guest function name for the PC
+	const auto get_function = [&](u32 type, u32 pc) -> std::string
+	{
+		if (type == 1)
+		{
+			const auto found = ppu_funcs.upper_bound(pc);
+
+			if (found != ppu_funcs.begin() && pc < std::prev(found)->first + std::prev(found)->second)
+			{
+				return fmt::format("ppu_0x%x", std::prev(found)->first);
+			}
+
+			return fmt::format("ppu_unknown_0x%x", pc);
+		}
+
+		if (spu_db)
+		{
+			if (const auto func = spu_db->find_function(pc))
+			{
+				return fmt::format("spu_0x%05x", func->addr);
+			}
+		}
+
+		return fmt::format("spu_unknown_0x%05x", pc);
+	};
+
+	// Aggregate samples as folded stacks (thread;function[;HLE function] count)
+	std::map<std::string, u64> folded;
+
+	for (const auto& thread : m_threads)
+	{
+		for (const auto& sample : thread.second.counts)
+		{
+			std::string stack = thread.second.name + ';' + get_function(thread.second.type, sample.first.first);
+
+			if (const char* hle = sample.first.second)
+			{
+				stack += ';';
+				stack += hle;
+			}
+
+			folded[stack] += sample.second;
+		}
+	}
+
+	std::string result;
+
+	for (const auto& stack : folded)
+	{
+		fmt::append(result, "%s %llu\n", stack.first, stack.second);
+	}
+
+	const std::string path = fs::get_config_dir() + "profile_" + (Emu.GetTitleID().empty() ? "unknown" : Emu.GetTitleID()) + ".folded";
+
+	fs::file file(path, fs::rewrite);
+
+	if (!file)
+	{
+		LOG_ERROR(GENERAL, "Profiler: failed to open %s", path);
+		return;
+	}
+
+	file.write(result);
+
+	LOG_SUCCESS(GENERAL, "Profiler: %llu ticks, %u threads, results written to %s", m_ticks, ::size32(m_threads), path);
+}
+
+bool cpu_profiler::start()
+{
+	if (Emu.IsStopped() || !fxm::make<cpu_profiler>())
+	{
+		return false;
+	}
+
+	LOG_NOTICE(GENERAL, "Profiler started");
+	return true;
+}
+
+bool cpu_profiler::stop()
+{
+	// Joins the thread which writes the results on exit
+	return fxm::remove<cpu_profiler>().value;
+}
+
+bool cpu_profiler::is_running()
+{
+	return fxm::check<cpu_profiler>().value;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "../Utilities/Thread.h"
+
+#include <map>
+
+// Guest code sampling profiler for PPU and SPU threads (no overhead when not running)
+class cpu_profiler final : public named_thread
+{
+	struct thread_samples
+	{
+		std::string name;
+		u32 type; // cpu_thread::id_type()
+		std::map<std::pair<u32, const char*>, u64> counts; // (PC, HLE function name) -> sample count
+	};
+
+	std::map<u32, thread_samples> m_threads; // cpu_thread::id -> samples
+
+	u64 m_ticks = 0;
+
+	void on_task() override;
+
+	void on_exit() override;
+
+	std::string get_name() const override { return "CPU Profiler"; }
+
+public:
+	// Start sampling (fails if already running or the emulation is stopped)
+	static bool start();
+
+	// Stop sampling and write folded stacks (fails if not running)
+	static bool stop();
+
+	// Check whether sampling is active
+	static bool is_running();
+};
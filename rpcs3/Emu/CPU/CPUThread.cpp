@@ -16,6 +16,7 @@ void fmt_class_string<cpu_flag>::format(std::string& out, u64 arg)
 		STR_CASE(cpu_flag::suspend);
 		STR_CASE(cpu_flag::ret);
 		STR_CASE(cpu_flag::signal);
+		STR_CASE(cpu_flag::yield);
 		STR_CASE(cpu_flag::dbg_global_pause);
 		STR_CASE(cpu_flag::dbg_global_stop);
 		STR_CASE(cpu_flag::dbg_pause);
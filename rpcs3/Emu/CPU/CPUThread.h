@@ -11,6 +11,7 @@ enum class cpu_flag : u32
 	suspend, // Thread paused
 	ret, // Callback return requested
 	signal, // Thread received a signal (HLE)
+	yield, // Thread must give up the execution slot (PPU scheduler)
 
 	dbg_global_pause, // Emulation paused
 	dbg_global_stop, // Emulation stopped
@@ -2,6 +2,7 @@
 #include "Utilities/Config.h"
 #include "Emu/System.h"
 #include "Emu/IdManager.h"
+#include "Emu/Benchmark.h"
 #include "Emu/Cell/PPUModule.h"
 
 #include "Emu/Cell/lv2/sys_event.h"
@@ -15,6 +16,151 @@ logs::channel cellAudio("cellAudio", logs::level::notice);
 
 cfg::bool_entry g_cfg_audio_dump_to_file(cfg::root.audio, "Dump to file");
 cfg::bool_entry g_cfg_audio_convert_to_u16(cfg::root.audio, "Convert to 16 bit");
+cfg::int_entry<0, 500> g_cfg_audio_target_latency(cfg::root.audio, "Target Latency (ms)", 0); // 0: adaptive buffering disabled
+
+// Mixer period (us): 256 samples at 48 kHz, 5.(3) ms
+static const u64 s_audio_period = AUDIO_SAMPLES * 1000000 / 48000;
+
+// Part of the wait below the host timer resolution (us), spent in yield()
+#ifdef _WIN32
+static const u64 s_audio_sleep_margin = 1000;
+#else
+static const u64 s_audio_sleep_margin = 200;
+#endif
+
+// Load 4 floats (reverse byte order)
+static inline __m128 audio_load(const be_t<f32>* src)
+{
+	return _mm_castsi128_ps(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3)));
+}
+
+// Mix 2-channel port data (volume per frame)
+static void audio_mix_2ch(const be_t<f32>* src, const f32* volume, f32* buf2ch, f32* buf8ch)
+{
+	for (u32 i = 0; i < BUFFER_SIZE; i += 2)
+	{
+		const __m128 vol = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(volume + i));
+		const __m128 data = _mm_mul_ps(audio_load(src + i * 2), _mm_unpacklo_ps(vol, vol));
+
+		_mm_storeu_ps(buf2ch + i * 2, _mm_add_ps(_mm_loadu_ps(buf2ch + i * 2), data));
+
+		// Front channels of two frames
+		__m128 out0 = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(buf8ch + i * 8));
+		__m128 out1 = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(buf8ch + i * 8 + 8));
+		_mm_storel_pi(reinterpret_cast<__m64*>(buf8ch + i * 8), _mm_add_ps(out0, data));
+		_mm_storel_pi(reinterpret_cast<__m64*>(buf8ch + i * 8 + 8), _mm_add_ps(out1, _mm_movehl_ps(data, data)));
+	}
+}
+
+// Mix 8-channel port data (volume per frame) with downmix to 2 channels
+static void audio_mix_8ch(const be_t<f32>* src, const f32* volume, f32* buf2ch, f32* buf8ch)
+{
+	const __m128 mid_k = _mm_set1_ps(0.708f);
+
+	for (u32 i = 0; i < BUFFER_SIZE; i++)
+	{
+		const __m128 vol = _mm_set1_ps(volume[i]);
+		const __m128 front = _mm_mul_ps(audio_load(src + i * 8), vol); // left, right, center, low_freq
+		const __m128 back = _mm_mul_ps(audio_load(src + i * 8 + 4), vol); // rear_left, rear_right, side_left, side_right
+
+		_mm_storeu_ps(buf8ch + i * 8, _mm_add_ps(_mm_loadu_ps(buf8ch + i * 8), front));
+		_mm_storeu_ps(buf8ch + i * 8 + 4, _mm_add_ps(_mm_loadu_ps(buf8ch + i * 8 + 4), back));
+
+		// left + rear_left + side_left + mid, right + rear_right + side_right + mid
+		const __m128 center = _mm_movehl_ps(front, front);
+		const __m128 mid = _mm_mul_ps(_mm_add_ps(center, _mm_shuffle_ps(center, center, 0xe1)), mid_k);
+		const __m128 sum = _mm_add_ps(_mm_add_ps(front, mid), _mm_add_ps(back, _mm_movehl_ps(back, back)));
+
+		const __m128 out = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(buf2ch + i * 2));
+		_mm_storel_pi(reinterpret_cast<__m64*>(buf2ch + i * 2), _mm_add_ps(out, sum));
+	}
+}
+
+audio_output_stage::audio_output_stage(u32 target_ms, u32 capacity)
+	: m_target(capacity ? std::min(target_ms * 48, capacity / 2) : target_ms * 48)
+	, m_limit(capacity ? std::min(m_target * 4, (capacity > max_frames ? capacity - max_frames : 0)) : m_target * 4)
+	, m_depth(m_target)
+{
+	if (m_target < target_ms * 48)
+	{
+		cellAudio.warning("Target latency reduced to %u ms (backend capacity: %u frames)", m_target / 48, capacity);
+	}
+}
+
+u32 audio_output_stage::process(AudioThread& audio, const f32* in, f32* out)
+{
+	if (!m_target)
+	{
+		std::memcpy(out, in, BUFFER_SIZE * 8 * sizeof(f32));
+		return BUFFER_SIZE;
+	}
+
+	const s32 depth = audio.GetQueuedFrames();
+
+	if (depth >= 0)
+	{
+		if (depth == 0 && m_started)
+		{
+			underruns++;
+			g_perf_counters.audio_underruns++;
+		}
+
+		if (static_cast<u32>(depth) > m_target * 2)
+		{
+			overruns++;
+			g_perf_counters.audio_overruns++;
+		}
+
+		// Too much latency to correct by resampling (or no room left in the backend)
+		if (static_cast<u32>(depth) > m_limit)
+		{
+			dropped++;
+			return 0;
+		}
+
+		m_started = true;
+		m_depth += (depth - m_depth) * 0.1;
+
+		const double correction = (m_depth - m_target) / m_target * s_gain;
+		m_ratio = 1.0 + (correction > s_max_correction ? s_max_correction : correction < -s_max_correction ? -s_max_correction : correction);
+	}
+
+	std::memcpy(m_buf + 3 * 8, in, BUFFER_SIZE * 8 * sizeof(f32));
+
+	u32 count = 0;
+
+	for (; count < max_frames; count++, m_pos += m_ratio)
+	{
+		const u32 i = static_cast<u32>(m_pos);
+
+		if (i > BUFFER_SIZE)
+		{
+			break;
+		}
+
+		const f32 t = static_cast<f32>(m_pos - i);
+		const f32 t2 = t * t;
+		const f32 t3 = t2 * t;
+		const __m128 c0 = _mm_set1_ps(-0.5f * t3 + t2 - 0.5f * t);
+		const __m128 c1 = _mm_set1_ps(1.5f * t3 - 2.5f * t2 + 1.0f);
+		const __m128 c2 = _mm_set1_ps(-1.5f * t3 + 2.0f * t2 + 0.5f * t);
+		const __m128 c3 = _mm_set1_ps(0.5f * t3 - 0.5f * t2);
+
+		for (u32 j = 0; j < 8; j += 4)
+		{
+			const f32* src = m_buf + (i - 1) * 8 + j;
+			const __m128 r0 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src), c0), _mm_mul_ps(_mm_loadu_ps(src + 8), c1));
+			const __m128 r1 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src + 16), c2), _mm_mul_ps(_mm_loadu_ps(src + 24), c3));
+			_mm_storeu_ps(out + count * 8 + j, _mm_add_ps(r0, r1));
+		}
+	}
+
+	// Keep the last frames as history
+	m_pos -= BUFFER_SIZE;
+	std::memmove(m_buf, m_buf + BUFFER_SIZE * 8, 3 * 8 * sizeof(f32));
+
+	return count;
+}
 
 void audio_config::on_task()
 {
@@ -29,19 +175,30 @@ void audio_config::on_task()
 
 	float buf2ch[2 * BUFFER_SIZE]{}; // intermediate buffer for 2 channels
 	float buf8ch[8 * BUFFER_SIZE]{}; // intermediate buffer for 8 channels
+	float volume[BUFFER_SIZE]; // port volume for each frame
 
 	static const size_t out_buffer_size = 8 * BUFFER_SIZE; // output buffer for 8 channels
 
-	std::unique_ptr<float[]> out_buffer[BUFFER_NUM];
+	// Output buffers must stay valid while queued by the backend (up to BUFFER_NUM, and one being filled)
+	static const u32 out_buffer_count = BUFFER_NUM + 1;
+
+	std::unique_ptr<float[]> out_buffer[out_buffer_count];
+	std::unique_ptr<u16[]> out_buffer_u16[out_buffer_count];
 
-	for (u32 i = 0; i < BUFFER_NUM; i++)
+	for (u32 i = 0; i < out_buffer_count; i++)
 	{
-		out_buffer[i].reset(new float[out_buffer_size] {});
+		out_buffer[i].reset(new float[8 * audio_output_stage::max_frames] {});
+		out_buffer_u16[i].reset(new u16[8 * audio_output_stage::max_frames] {});
 	}
 
 	const auto audio = Emu.GetCallbacks().get_audio();
 	audio->Open(buf8ch, out_buffer_size * (g_cfg_audio_convert_to_u16 ? 2 : 4));
 
+	audio_output_stage output(g_cfg_audio_target_latency, audio->GetMaxQueuedFrames());
+
+	u64 late_periods = 0;
+	u64 max_delay = 0;
+
 	while (fxm::check<audio_config>() && !Emu.IsStopped())
 	{
 		if (Emu.IsPaused())
@@ -56,19 +213,41 @@ void audio_config::on_task()
 
 		// TODO: send beforemix event (in ~2,6 ms before mixing)
 
-		// precise time of sleeping: 5,(3) ms (or 256/48000 sec)
+		// Absolute deadline of the period
 		const u64 expected_time = m_counter * AUDIO_SAMPLES * 1000000 / 48000;
 		if (expected_time >= time_pos)
 		{
-			std::this_thread::sleep_for(1ms); // hack
+			const u64 remaining = expected_time - time_pos;
+
+			if (remaining > s_audio_sleep_margin)
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(remaining - s_audio_sleep_margin));
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+
 			continue;
 		}
 
+		// Mixing started more than a period after the deadline
+		const u64 delay = time_pos - expected_time;
+
+		if (delay > s_audio_period)
+		{
+			late_periods++;
+			g_perf_counters.audio_late_periods++;
+		}
+
+		max_delay = std::max(max_delay, delay);
+
 		m_counter++;
 
-		const u32 out_pos = m_counter % BUFFER_NUM;
+		const u32 out_pos = m_counter % out_buffer_count;
 
-		bool first_mix = true;
+		std::memset(buf2ch, 0, sizeof(buf2ch));
+		std::memset(buf8ch, 0, sizeof(buf8ch));
 
 		// mixing:
 		for (auto& port : ports)
@@ -81,10 +260,8 @@ void audio_config::on_task()
 
 			auto buf = vm::_ptr<f32>(buf_addr);
 
-			static const float k = 1.0f; // may be 1.0f
-			const float& m = port.level;
-
-			auto step_volume = [](audio_port& port) // part of cellAudioSetPortLevel functionality
+			// Volume of each frame (part of cellAudioSetPortLevel functionality)
+			for (u32 i = 0; i < BUFFER_SIZE; i++)
 			{
 				const auto param = port.level_set.load();
 
@@ -99,112 +276,17 @@ void audio_config::on_task()
 						port.level_set.compare_and_swap(param, { param.value, 0.0f });
 					}
 				}
-			};
+
+				volume[i] = port.level;
+			}
 
 			if (port.channel == 2)
 			{
-				if (first_mix)
-				{
-					for (u32 i = 0; i < (sizeof(buf2ch) / sizeof(float)); i += 2)
-					{
-						step_volume(port);
-
-						// reverse byte order
-						const float left = buf[i + 0] * m;
-						const float right = buf[i + 1] * m;
-
-						buf2ch[i + 0] = left;
-						buf2ch[i + 1] = right;
-
-						buf8ch[i * 4 + 0] = left;
-						buf8ch[i * 4 + 1] = right;
-						buf8ch[i * 4 + 2] = 0.0f;
-						buf8ch[i * 4 + 3] = 0.0f;
-						buf8ch[i * 4 + 4] = 0.0f;
-						buf8ch[i * 4 + 5] = 0.0f;
-						buf8ch[i * 4 + 6] = 0.0f;
-						buf8ch[i * 4 + 7] = 0.0f;
-					}
-					first_mix = false;
-				}
-				else
-				{
-					for (u32 i = 0; i < (sizeof(buf2ch) / sizeof(float)); i += 2)
-					{
-						step_volume(port);
-
-						const float left = buf[i + 0] * m;
-						const float right = buf[i + 1] * m;
-
-						buf2ch[i + 0] += left;
-						buf2ch[i + 1] += right;
-
-						buf8ch[i * 4 + 0] += left;
-						buf8ch[i * 4 + 1] += right;
-					}
-				}
+				audio_mix_2ch(buf, volume, buf2ch, buf8ch);
 			}
 			else if (port.channel == 8)
 			{
-				if (first_mix)
-				{
-					for (u32 i = 0; i < (sizeof(buf2ch) / sizeof(float)); i += 2)
-					{
-						step_volume(port);
-
-						const float left = buf[i * 4 + 0] * m;
-						const float right = buf[i * 4 + 1] * m;
-						const float center = buf[i * 4 + 2] * m;
-						const float low_freq = buf[i * 4 + 3] * m;
-						const float rear_left = buf[i * 4 + 4] * m;
-						const float rear_right = buf[i * 4 + 5] * m;
-						const float side_left = buf[i * 4 + 6] * m;
-						const float side_right = buf[i * 4 + 7] * m;
-
-						const float mid = (center + low_freq) * 0.708f;
-						buf2ch[i + 0] = (left + rear_left + side_left + mid) * k;
-						buf2ch[i + 1] = (right + rear_right + side_right + mid) * k;
-
-						buf8ch[i * 4 + 0] = left;
-						buf8ch[i * 4 + 1] = right;
-						buf8ch[i * 4 + 2] = center;
-						buf8ch[i * 4 + 3] = low_freq;
-						buf8ch[i * 4 + 4] = rear_left;
-						buf8ch[i * 4 + 5] = rear_right;
-						buf8ch[i * 4 + 6] = side_left;
-						buf8ch[i * 4 + 7] = side_right;
-					}
-					first_mix = false;
-				}
-				else
-				{
-					for (u32 i = 0; i < (sizeof(buf2ch) / sizeof(float)); i += 2)
-					{
-						step_volume(port);
-
-						const float left = buf[i * 4 + 0] * m;
-						const float right = buf[i * 4 + 1] * m;
-						const float center = buf[i * 4 + 2] * m;
-						const float low_freq = buf[i * 4 + 3] * m;
-						const float rear_left = buf[i * 4 + 4] * m;
-						const float rear_right = buf[i * 4 + 5] * m;
-						const float side_left = buf[i * 4 + 6] * m;
-						const float side_right = buf[i * 4 + 7] * m;
-
-						const float mid = (center + low_freq) * 0.708f;
-						buf2ch[i + 0] += (left + rear_left + side_left + mid) * k;
-						buf2ch[i + 1] += (right + rear_right + side_right + mid) * k;
-
-						buf8ch[i * 4 + 0] += left;
-						buf8ch[i * 4 + 1] += right;
-						buf8ch[i * 4 + 2] += center;
-						buf8ch[i * 4 + 3] += low_freq;
-						buf8ch[i * 4 + 4] += rear_left;
-						buf8ch[i * 4 + 5] += rear_right;
-						buf8ch[i * 4 + 6] += side_left;
-						buf8ch[i * 4 + 7] += side_right;
-					}
-				}
+				audio_mix_8ch(buf, volume, buf2ch, buf8ch);
 			}
 			else
 			{
@@ -215,51 +297,41 @@ void audio_config::on_task()
 		}
 
 
-		if (!first_mix)
-		{
-			// copy output data (2 ch)
-			//for (u32 i = 0; i < (sizeof(buf2ch) / sizeof(float)); i++)
-			//{
-			//	out_buffer[out_pos][i] = buf2ch[i];
-			//}
-
-			// copy output data (8 ch)
-			for (u32 i = 0; i < (sizeof(buf8ch) / sizeof(float)); i++)
-			{
-				out_buffer[out_pos][i] = buf8ch[i];
-			}
-		}
+		// copy output data (8 ch), resample if necessary
+		const u32 out_frames = output.process(*audio, buf8ch, out_buffer[out_pos].get());
 
 		const u64 stamp1 = get_system_time();
 
-		if (first_mix)
+		// Nothing to submit if the block was dropped by the output stage
+		if (out_frames)
 		{
-			memset(out_buffer[out_pos].get(), 0, out_buffer_size * sizeof(float));
-		}
-
-		if (g_cfg_audio_convert_to_u16)
-		{
-			// convert the data from float to u16 with clipping:
-			// 2x MULPS
-			// 2x MAXPS (optional)
-			// 2x MINPS (optional)
-			// 2x CVTPS2DQ (converts float to s32)
-			// PACKSSDW (converts s32 to s16 with signed saturation)
-
-			u16 buf_u16[out_buffer_size];
-			for (size_t i = 0; i < out_buffer_size; i += 8)
+			if (g_cfg_audio_convert_to_u16)
 			{
+				// convert the data from float to u16 with clipping:
+				// 2x MULPS
+				// 2x MAXPS
+				// 2x MINPS
+				// 2x CVTPS2DQ (converts float to s32)
+				// PACKSSDW (converts s32 to s16 with signed saturation)
+
+				const auto buf_u16 = out_buffer_u16[out_pos].get();
 				const auto scale = _mm_set1_ps(0x8000);
-				(__m128i&)(buf_u16[i]) = _mm_packs_epi32(
-					_mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(out_buffer[out_pos].get() + i), scale)),
-					_mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(out_buffer[out_pos].get() + i + 4), scale)));
-			}
+				const auto min = _mm_set1_ps(-1.0f);
+				const auto max = _mm_set1_ps(1.0f);
 
-			audio->AddData(buf_u16, out_buffer_size * sizeof(u16));
-		}
-		else
-		{
-			audio->AddData(out_buffer[out_pos].get(), out_buffer_size * sizeof(float));
+				for (size_t i = 0; i < out_frames * 8; i += 8)
+				{
+					const auto data0 = _mm_min_ps(_mm_max_ps(_mm_load_ps(out_buffer[out_pos].get() + i), min), max);
+					const auto data1 = _mm_min_ps(_mm_max_ps(_mm_load_ps(out_buffer[out_pos].get() + i + 4), min), max);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(buf_u16 + i), _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(data0, scale)), _mm_cvtps_epi32(_mm_mul_ps(data1, scale))));
+				}
+
+				audio->AddData(buf_u16, out_frames * 8 * sizeof(u16));
+			}
+			else
+			{
+				audio->AddData(out_buffer[out_pos].get(), out_frames * 8 * sizeof(float));
+			}
 		}
 
 		const u64 stamp2 = get_system_time();
@@ -301,9 +373,19 @@ void audio_config::on_task()
 		case 8: m_dump.WriteData(&buf8ch, sizeof(buf8ch)); break; // write file data (8 ch)
 		}
 
+		g_perf_counters.audio_periods++;
+		g_perf_counters.audio_mix_time += stamp1 - stamp0;
+
 		cellAudio.trace("Audio perf: start=%d (access=%d, AddData=%d, events=%d, dump=%d)",
 			time_pos, stamp1 - stamp0, stamp2 - stamp1, stamp3 - stamp2, get_system_time() - stamp3);
 	}
+
+	cellAudio.notice("Audio thread: %llu periods, %llu late (max delay: %llu us)", m_counter, late_periods, max_delay);
+
+	if (g_cfg_audio_target_latency)
+	{
+		cellAudio.notice("Audio output: %llu underruns, %llu overruns, %llu blocks dropped (ratio: %.5f)", output.underruns, output.overruns, output.dropped, output.ratio());
+	}
 }
 
 s32 cellAudioInit()
@@ -87,6 +87,48 @@ enum : u32
 
 extern u64 get_system_time();
 
+class AudioThread;
+
+// Adaptive output buffering: keeps the backend queue at the target latency by resampling with a small ratio correction.
+// Resampling uses Catmull-Rom interpolation, the data is passed unmodified while the ratio is 1.
+class audio_output_stage
+{
+	static constexpr double s_max_correction = 0.005; // Max sample rate correction
+	static constexpr double s_gain = 0.01; // Correction per target of excess queue depth (before the limit)
+
+	const u32 m_target; // Target queue depth (frames), 0 if disabled
+	const u32 m_limit; // Max queue depth before dropping blocks (frames)
+
+	f32 m_buf[(BUFFER_SIZE + 3) * 8]{}; // Input with 3 frames of history
+	double m_pos = 1.0; // Position of the next output frame in m_buf
+	double m_ratio = 1.0; // Input frames per output frame
+	double m_depth; // Smoothed queue depth
+	bool m_started = false;
+
+public:
+	static const u32 max_frames = BUFFER_SIZE + 8; // Max output frames per block
+
+	u64 underruns = 0;
+	u64 overruns = 0;
+	u64 dropped = 0;
+
+	// The target is clamped to the half of the backend capacity (frames, 0 if unlimited)
+	audio_output_stage(u32 target_ms, u32 capacity = 0);
+
+	double ratio() const
+	{
+		return m_ratio;
+	}
+
+	u32 target() const
+	{
+		return m_target;
+	}
+
+	// Process 8-channel block of BUFFER_SIZE frames, return the amount of output frames (0 if dropped)
+	u32 process(AudioThread& audio, const f32* in, f32* out);
+};
+
 enum class audio_port_state : u32
 {
 	closed,
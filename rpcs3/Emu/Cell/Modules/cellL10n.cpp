@@ -15,6 +15,9 @@ typedef const char *HostCode;
 
 #include "cellL10n.h"
 
+#include <array>
+#include <unordered_map>
+
 logs::channel cellL10n("cellL10n", logs::level::notice);
 
 // Translate code id to code name. some codepage may has another name.
@@ -193,8 +196,359 @@ std::string _OemToOem(HostCode src_code, HostCode dst_code, const std::string st
 
 #endif
 
+// Unicode encodings are converted natively (big endian without BOM, as on PS3)
+static bool _L10nIsUnicode(s32 code)
+{
+	return code >= L10N_UTF8 && code <= L10N_UCS4;
+}
+
+// UTF-8 sequence length by the lead byte (0: illegal)
+static const std::array<u8, 256> s_utf8_length = []()
+{
+	std::array<u8, 256> table{};
+
+	for (u32 i = 0; i < 256; i++)
+	{
+		table[i] = i < 0x80 ? 1 : i < 0xc2 ? 0 : i < 0xe0 ? 2 : i < 0xf0 ? 3 : i < 0xf5 ? 4 : 0;
+	}
+
+	return table;
+}();
+
+// Decode one character (returns the size in bytes, 0 if incomplete, -1 if illegal)
+static s32 _L10nDecodeChar(s32 code, const u8* src, std::size_t len, u32& ch)
+{
+	switch (code)
+	{
+	case L10N_UTF8:
+	{
+		const u32 size = s_utf8_length[src[0]];
+
+		if (size == 0)
+		{
+			return -1;
+		}
+
+		if (size == 1)
+		{
+			ch = src[0];
+			return 1;
+		}
+
+		ch = src[0] & (0x7f >> size);
+
+		for (u32 i = 1; i < size; i++)
+		{
+			if (i >= len)
+			{
+				return 0;
+			}
+
+			if ((src[i] & 0xc0) != 0x80)
+			{
+				return -1;
+			}
+
+			ch = ch << 6 | (src[i] & 0x3f);
+		}
+
+		// Reject overlong sequences, surrogates and out of range values
+		if ((size == 3 && ch < 0x800) || (size == 4 && ch < 0x10000) || (ch >= 0xd800 && ch < 0xe000) || ch > 0x10ffff)
+		{
+			return -1;
+		}
+
+		return size;
+	}
+	case L10N_UTF16:
+	case L10N_UCS2:
+	{
+		if (len < 2)
+		{
+			return 0;
+		}
+
+		ch = src[0] << 8 | src[1];
+
+		if (ch < 0xd800 || ch >= 0xe000)
+		{
+			return 2;
+		}
+
+		if (code == L10N_UCS2 || ch >= 0xdc00)
+		{
+			return -1;
+		}
+
+		if (len < 4)
+		{
+			return 0;
+		}
+
+		const u32 low = src[2] << 8 | src[3];
+
+		if (low < 0xdc00 || low >= 0xe000)
+		{
+			return -1;
+		}
+
+		ch = 0x10000 + ((ch - 0xd800) << 10) + (low - 0xdc00);
+		return 4;
+	}
+	case L10N_UTF32:
+	case L10N_UCS4:
+	{
+		if (len < 4)
+		{
+			return 0;
+		}
+
+		ch = src[0] << 24 | src[1] << 16 | src[2] << 8 | src[3];
+
+		if ((ch >= 0xd800 && ch < 0xe000) || ch > 0x10ffff)
+		{
+			return -1;
+		}
+
+		return 4;
+	}
+	}
+
+	return -1;
+}
+
+// Encode one character (returns the size in bytes, -1 if not representable)
+static s32 _L10nEncodeChar(s32 code, u32 ch, u8* dst)
+{
+	switch (code)
+	{
+	case L10N_UTF8:
+	{
+		if (ch < 0x80)
+		{
+			dst[0] = static_cast<u8>(ch);
+			return 1;
+		}
+
+		if (ch < 0x800)
+		{
+			dst[0] = static_cast<u8>(0xc0 | ch >> 6);
+			dst[1] = static_cast<u8>(0x80 | (ch & 0x3f));
+			return 2;
+		}
+
+		if (ch < 0x10000)
+		{
+			dst[0] = static_cast<u8>(0xe0 | ch >> 12);
+			dst[1] = static_cast<u8>(0x80 | (ch >> 6 & 0x3f));
+			dst[2] = static_cast<u8>(0x80 | (ch & 0x3f));
+			return 3;
+		}
+
+		dst[0] = static_cast<u8>(0xf0 | ch >> 18);
+		dst[1] = static_cast<u8>(0x80 | (ch >> 12 & 0x3f));
+		dst[2] = static_cast<u8>(0x80 | (ch >> 6 & 0x3f));
+		dst[3] = static_cast<u8>(0x80 | (ch & 0x3f));
+		return 4;
+	}
+	case L10N_UTF16:
+	case L10N_UCS2:
+	{
+		if (ch < 0x10000)
+		{
+			dst[0] = static_cast<u8>(ch >> 8);
+			dst[1] = static_cast<u8>(ch);
+			return 2;
+		}
+
+		if (code == L10N_UCS2)
+		{
+			return -1;
+		}
+
+		const u32 high = 0xd800 + ((ch - 0x10000) >> 10);
+		const u32 low = 0xdc00 + ((ch - 0x10000) & 0x3ff);
+		dst[0] = static_cast<u8>(high >> 8);
+		dst[1] = static_cast<u8>(high);
+		dst[2] = static_cast<u8>(low >> 8);
+		dst[3] = static_cast<u8>(low);
+		return 4;
+	}
+	case L10N_UTF32:
+	case L10N_UCS4:
+	{
+		dst[0] = 0;
+		dst[1] = static_cast<u8>(ch >> 16);
+		dst[2] = static_cast<u8>(ch >> 8);
+		dst[3] = static_cast<u8>(ch);
+		return 4;
+	}
+	}
+
+	return -1;
+}
+
+// Convert between Unicode encodings (same results as the iconv path)
+static s32 _L10nConvertUnicode(s32 src_code, const u8* src, std::size_t src_len, s32 dst_code, u8* dst, s32* dst_len, bool allowIncomplete)
+{
+	const std::size_t max = dst ? std::max<s32>(*dst_len, 0) : SIZE_MAX;
+	const __m128i zero = _mm_setzero_si128();
+
+	std::size_t pos = 0;
+	std::size_t out = 0;
+	s32 result = ConversionOK;
+
+	while (pos < src_len)
+	{
+		// ASCII fast path: UTF-8 to UTF-8, UTF-16 or UCS-2 (16 characters at once)
+		if (src_code == L10N_UTF8 && src[pos] < 0x80 && (dst_code == L10N_UTF8 || dst_code == L10N_UTF16 || dst_code == L10N_UCS2))
+		{
+			const std::size_t width = dst_code == L10N_UTF8 ? 1 : 2;
+
+			while (src_len - pos >= 16 && (!dst || max - out >= 16 * width))
+			{
+				const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pos));
+
+				if (_mm_movemask_epi8(data))
+				{
+					break;
+				}
+
+				if (dst && width == 1)
+				{
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + out), data);
+				}
+				else if (dst)
+				{
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + out), _mm_unpacklo_epi8(zero, data));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + out + 16), _mm_unpackhi_epi8(zero, data));
+				}
+
+				pos += 16;
+				out += 16 * width;
+			}
+		}
+
+		// ASCII fast path: UTF-16 or UCS-2 to UTF-8 (8 characters at once)
+		if (dst_code == L10N_UTF8 && (src_code == L10N_UTF16 || src_code == L10N_UCS2))
+		{
+			while (src_len - pos >= 16 && (!dst || max - out >= 8))
+			{
+				const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pos));
+
+				// Big endian characters loaded as little endian: the high byte must be 0, the low byte must be < 0x80
+				if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(data, _mm_set1_epi16(static_cast<s16>(0x80ff))), zero)) != 0xffff)
+				{
+					break;
+				}
+
+				if (dst)
+				{
+					_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + out), _mm_packus_epi16(_mm_srli_epi16(data, 8), zero));
+				}
+
+				pos += 16;
+				out += 8;
+			}
+		}
+
+		if (pos >= src_len)
+		{
+			break;
+		}
+
+		u32 ch;
+		const s32 size = _L10nDecodeChar(src_code, src + pos, src_len - pos, ch);
+
+		if (size == 0)
+		{
+			if (allowIncomplete)
+			{
+				*dst_len = -1; // TODO: correct value?
+				return ConversionOK;
+			}
+
+			result = SRCIllegal;
+			break;
+		}
+
+		u8 buf[4];
+		const s32 count = size < 0 ? -1 : _L10nEncodeChar(dst_code, ch, buf);
+
+		if (count < 0)
+		{
+			result = SRCIllegal;
+			break;
+		}
+
+		if (dst)
+		{
+			if (max - out < static_cast<u32>(count))
+			{
+				result = DSTExhausted;
+				break;
+			}
+
+			std::memcpy(dst + out, buf, count);
+		}
+
+		pos += size;
+		out += count;
+	}
+
+	*dst_len = static_cast<s32>(out);
+	return result;
+}
+
+#ifndef _MSC_VER
+
+// Cached iconv descriptors (per host thread, by code pair)
+class l10n_iconv_cache
+{
+	std::unordered_map<u32, iconv_t> m_map;
+
+public:
+	~l10n_iconv_cache()
+	{
+		for (auto& pair : m_map)
+		{
+			iconv_close(pair.second);
+		}
+	}
+
+	// Get the descriptor in the initial state ((iconv_t)-1 on failure)
+	iconv_t get(s32 src_code, HostCode src, s32 dst_code, HostCode dst)
+	{
+		const u32 key = src_code << 16 | (dst_code & 0xffff);
+
+		const auto found = m_map.find(key);
+
+		if (found != m_map.end())
+		{
+			iconv(found->second, nullptr, nullptr, nullptr, nullptr);
+			return found->second;
+		}
+
+		const iconv_t ict = iconv_open(dst, src);
+
+		if (ict != reinterpret_cast<iconv_t>(-1))
+		{
+			m_map.emplace(key, ict);
+		}
+
+		return ict;
+	}
+};
+
+#endif
+
 s32 _ConvertStr(s32 src_code, const void *src, s32 src_len, s32 dst_code, void *dst, s32 *dst_len, bool allowIncomplete)
 {
+	if (_L10nIsUnicode(src_code) && _L10nIsUnicode(dst_code))
+	{
+		return _L10nConvertUnicode(src_code, static_cast<const u8*>(src), src_len, dst_code, static_cast<u8*>(dst), dst_len, allowIncomplete);
+	}
+
 	HostCode srcCode = 0, dstCode = 0;	//OEM code pages
 	bool src_page_converted = _L10nCodeParse(src_code, srcCode);	//Check if code is in list.
 	bool dst_page_converted = _L10nCodeParse(dst_code, dstCode);
@@ -216,8 +570,12 @@ s32 _ConvertStr(s32 src_code, const void *src, s32 src_len, s32 dst_code, void *
 
 	return ConversionOK;
 #else
+	thread_local l10n_iconv_cache s_iconv_cache;
+
 	s32 retValue = ConversionOK;
-	iconv_t ict = iconv_open(dstCode, srcCode);
+	iconv_t ict = s_iconv_cache.get(src_code, srcCode, dst_code, dstCode);
+	if (ict == reinterpret_cast<iconv_t>(-1))
+		return ConverterUnknown;
 	size_t srcLen = src_len;
 	if (dst != NULL)
 	{
@@ -264,7 +622,6 @@ s32 _ConvertStr(s32 src_code, const void *src, s32 src_len, s32 dst_code, void *
 			}
 		}
 	}
-	iconv_close(ict);
 	return retValue;
 #endif
 }
@@ -9,6 +9,8 @@
 
 #include <mutex>
 #include <algorithm>
+#include <map>
+#include <set>
 
 logs::channel cellSaveData("cellSaveData", logs::level::notice);
 
@@ -37,6 +39,304 @@ enum : u32
 
 std::mutex g_savedata_mutex;
 
+// Savedata directory metadata index (PARAM.SFO parameters and total size) of the user, cached in data/savedata/<user>.bin.
+// Entries are validated by the directory mtime and PARAM.SFO mtime and size (it may be rewritten in place),
+// and refreshed by savedata_op after the directory is accessed.
+class savedata_index
+{
+	static const u32 s_magic = 0x58494453; // "SDIX"
+	static const u32 s_version = 2;
+
+	// Validation key
+	struct key_t
+	{
+		s64 dir_mtime;
+		s64 sfo_mtime; // PARAM.SFO (0 if not found)
+		u64 sfo_size;
+
+		bool operator ==(const key_t& rhs) const
+		{
+			return dir_mtime == rhs.dir_mtime && sfo_mtime == rhs.sfo_mtime && sfo_size == rhs.sfo_size;
+		}
+
+		bool operator !=(const key_t& rhs) const
+		{
+			return !(*this == rhs);
+		}
+	};
+
+	struct entry_t
+	{
+		key_t key;
+		bool valid; // PARAM.SFO found
+		SaveDataEntry info;
+	};
+
+	const std::string m_path;
+	std::string m_base_dir;
+	std::map<std::string, entry_t> m_entries; // By directory name
+	bool m_dirty = false;
+
+	static void write_string(const fs::file& file, const std::string& str)
+	{
+		file.write(::size32(str));
+		file.write(str);
+	}
+
+	static std::string read_string(const fs::file& file)
+	{
+		std::string result;
+		if (!file.read(result, file.read<u32>())) fmt::throw_exception("Unexpected end of file" HERE);
+		return result;
+	}
+
+	bool load(const fs::file& file)
+	{
+		if (file.size() < 12 || file.read<u32>() != s_magic || file.read<u32>() != s_version)
+		{
+			return false;
+		}
+
+		m_base_dir = read_string(file);
+
+		for (u32 i = 0, count = file.read<u32>(); i < count; i++)
+		{
+			const std::string name = read_string(file);
+
+			entry_t& entry = m_entries[name];
+			entry.key.dir_mtime = file.read<s64>();
+			entry.key.sfo_mtime = file.read<s64>();
+			entry.key.sfo_size = file.read<u64>();
+			entry.valid = file.read<u8>() != 0;
+			entry.info.size = file.read<u64>();
+			entry.info.dirName = read_string(file);
+			entry.info.listParam = read_string(file);
+			entry.info.title = read_string(file);
+			entry.info.subtitle = read_string(file);
+			entry.info.details = read_string(file);
+			entry.info.isNew = false;
+		}
+
+		return true;
+	}
+
+	// Get the validation key of the directory
+	static key_t get_key(const std::string& path, s64 dir_mtime)
+	{
+		key_t result{dir_mtime, 0, 0};
+
+		fs::stat_t sfo_info{};
+
+		if (fs::stat(path + "/PARAM.SFO", sfo_info))
+		{
+			result.sfo_mtime = sfo_info.mtime;
+			result.sfo_size = sfo_info.size;
+		}
+
+		return result;
+	}
+
+	// Read the directory, return false if the entry didn't change
+	static bool read_entry(const std::string& path, const key_t& key, entry_t& entry)
+	{
+		entry_t result{};
+		result.key = key;
+
+		const auto& psf = psf::load_object(fs::file(path + "/PARAM.SFO"));
+
+		if (!psf.empty())
+		{
+			result.valid = true;
+			result.info.dirName = psf.at("SAVEDATA_DIRECTORY").as_string();
+			result.info.listParam = psf.at("SAVEDATA_LIST_PARAM").as_string();
+			result.info.title = psf.at("TITLE").as_string();
+			result.info.subtitle = psf.at("SUB_TITLE").as_string();
+			result.info.details = psf.at("DETAIL").as_string();
+			result.info.size = 0;
+
+			for (const auto& entry2 : fs::dir(path))
+			{
+				result.info.size += entry2.size;
+			}
+		}
+
+		if (entry.key == result.key && entry.valid == result.valid && entry.info.size == result.info.size &&
+			entry.info.dirName == result.info.dirName && entry.info.listParam == result.info.listParam && entry.info.title == result.info.title &&
+			entry.info.subtitle == result.info.subtitle && entry.info.details == result.info.details)
+		{
+			return false;
+		}
+
+		entry = std::move(result);
+		return true;
+	}
+
+public:
+	savedata_index(u32 user_id, const std::string& base_dir)
+		: m_path(fs::get_config_dir() + fmt::format("data/savedata/%08u.bin", user_id))
+	{
+		if (const fs::file file{m_path})
+		{
+			try
+			{
+				if (!load(file))
+				{
+					m_entries.clear();
+				}
+			}
+			catch (const std::exception&)
+			{
+				cellSaveData.error("Invalid savedata index file: %s", m_path);
+				m_entries.clear();
+			}
+		}
+
+		// The index is only valid for the same directory
+		if (m_base_dir != base_dir)
+		{
+			m_base_dir = base_dir;
+			m_entries.clear();
+			m_dirty = true;
+		}
+	}
+
+	// Get the entry (reads the directory if the entry is outdated), returns nullptr if PARAM.SFO is not found
+	const SaveDataEntry* get(const fs::dir_entry& dir)
+	{
+		const auto found = m_entries.find(dir.name);
+
+		entry_t& entry = found != m_entries.end() ? found->second : m_entries[dir.name];
+
+		const key_t key = get_key(m_base_dir + dir.name, dir.mtime);
+
+		if (found == m_entries.end() || entry.key != key)
+		{
+			m_dirty |= read_entry(m_base_dir + dir.name, key, entry);
+		}
+
+		entry.info.atime = dir.atime;
+		entry.info.mtime = dir.mtime;
+		entry.info.ctime = dir.ctime;
+		entry.info.isNew = false;
+		return entry.valid ? &entry.info : nullptr;
+	}
+
+	// Read the directory again (after modification)
+	void update(const std::string& name)
+	{
+		if (name.empty())
+		{
+			return;
+		}
+
+		fs::stat_t dir_info{};
+
+		if (!fs::stat(m_base_dir + name, dir_info) || !dir_info.is_directory)
+		{
+			m_dirty |= m_entries.erase(name) != 0;
+			return;
+		}
+
+		m_dirty |= read_entry(m_base_dir + name, get_key(m_base_dir + name, dir_info.mtime), m_entries[name]);
+	}
+
+	// Remove entries of the directories which don't exist anymore
+	void retain(const std::set<std::string>& names)
+	{
+		for (auto it = m_entries.begin(); it != m_entries.end();)
+		{
+			if (names.count(it->first))
+			{
+				it++;
+			}
+			else
+			{
+				it = m_entries.erase(it);
+				m_dirty = true;
+			}
+		}
+	}
+
+	// Write the index file if modified
+	void save()
+	{
+		if (!m_dirty || !fs::create_path(fs::get_parent_dir(m_path)))
+		{
+			return;
+		}
+
+		m_dirty = false;
+
+		if (const fs::file file{m_path + ".tmp", fs::rewrite})
+		{
+			file.write(s_magic);
+			file.write(s_version);
+			write_string(file, m_base_dir);
+			file.write(::size32(m_entries));
+
+			for (const auto& pair : m_entries)
+			{
+				const entry_t& entry = pair.second;
+				write_string(file, pair.first);
+				file.write(entry.key.dir_mtime);
+				file.write(entry.key.sfo_mtime);
+				file.write(entry.key.sfo_size);
+				file.write<u8>(entry.valid);
+				file.write(entry.info.size);
+				write_string(file, entry.info.dirName);
+				write_string(file, entry.info.listParam);
+				write_string(file, entry.info.title);
+				write_string(file, entry.info.subtitle);
+				write_string(file, entry.info.details);
+			}
+		}
+
+		fs::rename(m_path + ".tmp", m_path);
+	}
+
+	// Get the index of the user (g_savedata_mutex must be locked)
+	static savedata_index& get_index(u32 user_id, const std::string& base_dir)
+	{
+		static std::map<u32, std::unique_ptr<savedata_index>> s_indices;
+
+		auto& index = s_indices[user_id];
+
+		if (!index || index->m_base_dir != base_dir)
+		{
+			index = std::make_unique<savedata_index>(user_id, base_dir);
+		}
+
+		return *index;
+	}
+};
+
+// Refresh the index entry of the accessed directory at the end of the scope
+class savedata_index_update
+{
+	savedata_index& m_index;
+	const std::string& m_name;
+
+public:
+	savedata_index_update(savedata_index& index, const std::string& name)
+		: m_index(index)
+		, m_name(name)
+	{
+	}
+
+	~savedata_index_update()
+	{
+		try
+		{
+			m_index.update(m_name);
+			m_index.save();
+		}
+		catch (const std::exception& e)
+		{
+			cellSaveData.error("Failed to update savedata index: %s", e.what());
+		}
+	}
+};
+
 static NEVER_INLINE s32 savedata_op(ppu_thread& ppu, u32 operation, u32 version, vm::cptr<char> dirName,
 	u32 errDialog, PSetList setList, PSetBuf setBuf, PFuncList funcList, PFuncFixed funcFixed, PFuncStat funcStat,
 	PFuncFile funcFile, u32 container, u32 unknown, vm::ptr<void> userdata, u32 userId, PFuncDone funcDone)
@@ -62,6 +362,8 @@ static NEVER_INLINE s32 savedata_op(ppu_thread& ppu, u32 operation, u32 version,
 	// path of the specified user (00000001 by default)
 	const std::string& base_dir = vfs::get(fmt::format("/dev_hdd0/home/%08u/savedata/", userId ? userId : 1u));
 
+	savedata_index& index = savedata_index::get_index(userId ? userId : 1u, base_dir);
+
 	result->userdata = userdata; // probably should be assigned only once (allows the callback to change it)
 
 	SaveDataEntry save_entry;
@@ -77,13 +379,17 @@ static NEVER_INLINE s32 savedata_op(ppu_thread& ppu, u32 operation, u32 version,
 
 		const auto prefix_list = fmt::split(setList->dirNamePrefix.get_ptr(), { "|" });
 
+		std::set<std::string> dir_names;
+
 		for (const auto& entry : fs::dir(base_dir))
 		{
-			if (!entry.is_directory)
+			if (!entry.is_directory || entry.name == "." || entry.name == "..")
 			{
 				continue;
 			}
 
+			dir_names.emplace(entry.name);
+
 			for (const auto& prefix : prefix_list)
 			{
 				if (entry.name.substr(0, prefix.size()) == prefix)
@@ -93,36 +399,11 @@ static NEVER_INLINE s32 savedata_op(ppu_thread& ppu, u32 operation, u32 version,
 					{
 						listGet->dirNum++;
 
-						// PSF parameters
-						const auto& psf = psf::load_object(fs::file(base_dir + entry.name + "/PARAM.SFO"));
-
-						if (psf.empty())
+						// PSF parameters and size (cached)
+						if (const auto save_entry2 = index.get(entry))
 						{
-							break;
+							save_entries.push_back(*save_entry2);
 						}
-
-						SaveDataEntry save_entry2;
-						save_entry2.dirName = psf.at("SAVEDATA_DIRECTORY").as_string();
-						save_entry2.listParam = psf.at("SAVEDATA_LIST_PARAM").as_string();
-						save_entry2.title = psf.at("TITLE").as_string();
-						save_entry2.subtitle = psf.at("SUB_TITLE").as_string();
-						save_entry2.details = psf.at("DETAIL").as_string();
-
-						save_entry2.size = 0;
-
-						for (const auto entry2 : fs::dir(base_dir + entry.name))
-						{
-							save_entry2.size += entry2.size;
-						}
-
-						save_entry2.atime = entry.atime;
-						save_entry2.mtime = entry.mtime;
-						save_entry2.ctime = entry.ctime;
-						//save_entry2.iconBuf = NULL; // TODO: Here should be the PNG buffer
-						//save_entry2.iconBufSize = 0; // TODO: Size of the PNG file
-						save_entry2.isNew = false;
-
-						save_entries.push_back(save_entry2);
 					}
 
 					break;
@@ -130,6 +411,9 @@ static NEVER_INLINE s32 savedata_op(ppu_thread& ppu, u32 operation, u32 version,
 			}
 		}
 
+		index.retain(dir_names);
+		index.save();
+
 		// Sort the entries
 		{
 			const u32 order = setList->sortOrder;
@@ -335,6 +619,9 @@ static NEVER_INLINE s32 savedata_op(ppu_thread& ppu, u32 operation, u32 version,
 		save_entry.dirName = dirName.get_ptr();
 	}
 
+	// Directory contents may be modified below
+	const savedata_index_update index_update(index, save_entry.dirName);
+
 	std::string dir_path = base_dir + save_entry.dirName + "/";
 	std::string sfo_path = dir_path + "PARAM.SFO";
 
@@ -1,12 +1,20 @@
 #include "stdafx.h"
+#include "Utilities/Config.h"
+#include "Utilities/Thread.h"
+#include "Crypto/sha1.h"
 #include "PPUOpcodes.h"
 #include "PPUModule.h"
 #include "PPUAnalyser.h"
 
 #include <unordered_set>
+#include <algorithm>
+#include <thread>
+#include <mutex>
 
 #include "yaml-cpp/yaml.h"
 
+cfg::bool_entry g_cfg_ppu_analysis_cache(cfg::root.core, "Cache PPU analysis", true);
+
 const ppu_decoder<ppu_itype> s_ppu_itype;
 const ppu_decoder<ppu_iname> s_ppu_iname;
 
@@ -107,6 +115,50 @@ void ppu_validate(const std::string& fname, const std::vector<ppu_function>& fun
 	}
 }
 
+void ppu_parallel_for(u32 count, const std::function<void(u32)>& func)
+{
+	atomic_t<u32> next{0};
+	std::exception_ptr error;
+	std::mutex error_mutex;
+
+	auto worker = [&]()
+	{
+		for (u32 index; (index = next++) < count;)
+		{
+			try
+			{
+				func(index);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(error_mutex);
+				if (!error) error = std::current_exception();
+			}
+		}
+	};
+
+	// The current thread takes part
+	const u32 thread_count = std::min<u32>(std::max<u32>(std::thread::hardware_concurrency(), 1), count);
+	std::vector<std::shared_ptr<thread_ctrl>> threads(thread_count > 1 ? thread_count - 1 : 0);
+
+	for (auto& thread : threads)
+	{
+		thread_ctrl::spawn(thread, "PPU Analyser", worker);
+	}
+
+	worker();
+
+	for (auto& thread : threads)
+	{
+		thread->join();
+	}
+
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
+}
+
 static u32 ppu_test(const vm::cptr<u32> ptr, vm::cptr<void> fend, ppu_pattern_array pat)
 {
 	vm::cptr<u32> cur = ptr;
@@ -326,7 +378,7 @@ namespace ppu_patterns
 	};
 }
 
-std::vector<ppu_function> ppu_analyse(const std::vector<std::pair<u32, u32>>& segs, const std::vector<std::pair<u32, u32>>& secs, u32 lib_toc)
+static std::vector<ppu_function> ppu_analyse_impl(const std::vector<std::pair<u32, u32>>& segs, const std::vector<std::pair<u32, u32>>& secs, u32 lib_toc)
 {
 	// Assume first segment is executable
 	const u32 start = segs[0].first;
@@ -369,6 +421,75 @@ std::vector<ppu_function> ppu_analyse(const std::vector<std::pair<u32, u32>>& se
 		return func;
 	};
 
+	// Words of the segments which may point to a function (aligned, in the executable segment)
+	struct word_ref
+	{
+		u32 value;
+		u32 next; // Following word (TOC of OPD entry candidates)
+		u32 seq; // Position in the segments (scan order)
+		u32 addr;
+	};
+
+	// Sorted by the following word and by the value (scan order is preserved for equal keys)
+	std::vector<word_ref> opd_index;
+	std::vector<word_ref> ptr_index;
+	bool index_built = false;
+
+	// Scan the segments once (in parallel) instead of scanning them for every TOC or function without size
+	auto build_index = [&]()
+	{
+		if (index_built)
+		{
+			return;
+		}
+
+		index_built = true;
+
+		// Split the segments in chunks, positions of different segments are never adjacent
+		std::vector<std::pair<u32, u32>> chunks;
+		std::vector<u32> chunk_seq;
+
+		for (u32 i = 0, seq = 0; i < segs.size(); i++)
+		{
+			const u32 words = (segs[i].second + 3) / 4;
+
+			for (u32 pos = 0; pos < words; pos += 0x40000)
+			{
+				chunks.emplace_back(segs[i].first + pos * 4, std::min<u32>(0x40000, words - pos));
+				chunk_seq.emplace_back(seq + pos);
+			}
+
+			seq += words + 1;
+		}
+
+		std::vector<std::vector<word_ref>> found(chunks.size());
+
+		ppu_parallel_for(::size32(chunks), [&](u32 i)
+		{
+			const vm::cptr<u32> ptr = vm::cast(chunks[i].first);
+
+			for (u32 j = 0; j < chunks[i].second; j++)
+			{
+				const u32 value = ptr[j];
+
+				if (value >= start && value < end && value % 4 == 0)
+				{
+					found[i].push_back({value, ptr[j + 1], chunk_seq[i] + j, (ptr + j).addr()});
+				}
+			}
+		});
+
+		for (auto& refs : found)
+		{
+			ptr_index.insert(ptr_index.end(), refs.begin(), refs.end());
+		}
+
+		opd_index = ptr_index;
+
+		std::stable_sort(opd_index.begin(), opd_index.end(), [](const word_ref& a, const word_ref& b) { return a.next < b.next; });
+		std::stable_sort(ptr_index.begin(), ptr_index.end(), [](const word_ref& a, const word_ref& b) { return a.value < b.value; });
+	};
+
 	// Register new TOC and find basic set of functions
 	auto add_toc = [&](u32 toc)
 	{
@@ -377,19 +498,23 @@ std::vector<ppu_function> ppu_analyse(const std::vector<std::pair<u32, u32>>& se
 			return;
 		}
 
-		// Grope for OPD section (TODO: optimization, better constraints)
-		for (const auto& seg : segs)
+		// Grope for OPD section (TODO: better constraints)
+		build_index();
+
+		u32 skip_seq = -1;
+
+		for (auto it = std::lower_bound(opd_index.begin(), opd_index.end(), toc, [](const word_ref& ref, u32 toc) { return ref.next < toc; }); it != opd_index.end() && it->next == toc; it++)
 		{
-			for (vm::cptr<u32> ptr = vm::cast(seg.first); ptr.addr() < seg.first + seg.second; ptr++)
+			// The TOC word of the previous entry
+			if (it->seq == skip_seq)
 			{
-				if (ptr[0] >= start && ptr[0] < end && ptr[0] % 4 == 0 && ptr[1] == toc)
-				{
-					// New function
-					LOG_TRACE(PPU, "OPD*: [0x%x] 0x%x (TOC=0x%x)", ptr, ptr[0], ptr[1]);
-					add_func(*ptr, toc, ptr.addr());
-					ptr++;
-				}
+				continue;
 			}
+
+			// New function
+			LOG_TRACE(PPU, "OPD*: [0x%x] 0x%x (TOC=0x%x)", it->addr, it->value, toc);
+			add_func(it->value, toc, it->addr);
+			skip_seq = it->seq + 1;
 		}
 	};
 
@@ -744,18 +869,21 @@ std::vector<ppu_function> ppu_analyse(const std::vector<std::pair<u32, u32>>& se
 			// Get limit
 			const u32 func_end2 = _next == funcs.end() ? func_end : std::min<u32>(_next->first, func_end);
 
-			// Find more block entries
-			for (const auto& seg : segs)
+			// Find more block entries (in scan order)
+			build_index();
+
+			std::vector<std::pair<u32, u32>> entries;
+
+			for (auto it = std::lower_bound(ptr_index.begin(), ptr_index.end(), func.addr, [](const word_ref& ref, u32 addr) { return ref.value < addr; }); it != ptr_index.end() && it->value < func_end2; it++)
 			{
-				for (vm::cptr<u32> ptr = vm::cast(seg.first); ptr.addr() < seg.first + seg.second; ptr++)
-				{
-					const u32 value = *ptr;
+				entries.emplace_back(it->seq, it->value);
+			}
 
-					if (value % 4 == 0 && value >= func.addr && value < func_end2)
-					{
-						add_block(value);
-					}
-				}
+			std::sort(entries.begin(), entries.end());
+
+			for (const auto& entry : entries)
+			{
+				add_block(entry.second);
 			}
 		}
 
@@ -1009,3 +1137,172 @@ std::vector<ppu_function> ppu_analyse(const std::vector<std::pair<u32, u32>>& se
 
 	return result;
 }
+
+namespace
+{
+	const u32 s_analysis_magic = 0x41555050; // "PPUA"
+	const u32 s_analysis_version = 1;
+
+	// Cache file name from the analysed memory and parameters
+	std::string get_analysis_cache_path(const std::vector<std::pair<u32, u32>>& segs, const std::vector<std::pair<u32, u32>>& secs, u32 lib_toc)
+	{
+		sha1_context ctx;
+		sha1_starts(&ctx);
+
+		for (const auto& seg : segs)
+		{
+			sha1_update(&ctx, reinterpret_cast<const u8*>(&seg), sizeof(seg));
+			sha1_update(&ctx, vm::ps3::_ptr<const u8>(seg.first), seg.second);
+		}
+
+		for (const auto& sec : secs)
+		{
+			sha1_update(&ctx, reinterpret_cast<const u8*>(&sec), sizeof(sec));
+		}
+
+		sha1_update(&ctx, reinterpret_cast<const u8*>(&lib_toc), sizeof(lib_toc));
+
+		u8 hash[20];
+		sha1_finish(&ctx, hash);
+
+		std::string name;
+
+		for (u8 byte : hash)
+		{
+			fmt::append(name, "%02x", byte);
+		}
+
+		return fs::get_config_dir() + "data/ppu/" + name + ".bin";
+	}
+
+	bool load_analysis(const fs::file& file, std::vector<ppu_function>& result)
+	{
+		if (file.size() < 12 || file.read<u32>() != s_analysis_magic || file.read<u32>() != s_analysis_version)
+		{
+			return false;
+		}
+
+		const u32 count = file.read<u32>();
+
+		// Each function takes at least 32 bytes (don't trust the counts of a truncated file)
+		if (count > file.size() / 32)
+		{
+			return false;
+		}
+
+		result.resize(count);
+
+		for (auto& func : result)
+		{
+			u32 data[6];
+
+			if (!file.read(data))
+			{
+				return false;
+			}
+
+			func.addr = data[0];
+			func.toc = data[1];
+			func.size = data[2];
+			func.attr = static_cast<bs_t<ppu_attr>>(data[3]);
+			func.stack_frame = data[4];
+			func.gate_target = data[5];
+
+			// Blocks are stored as address/size pairs
+			std::vector<u32> blocks;
+			std::vector<u32> calls;
+			const u32 block_count = file.read<u32>();
+
+			if (block_count > file.size() / 8 || !file.read(blocks, block_count * 2))
+			{
+				return false;
+			}
+
+			const u32 call_count = file.read<u32>();
+
+			if (call_count > file.size() / 4 || !file.read(calls, call_count))
+			{
+				return false;
+			}
+
+			for (std::size_t i = 0; i + 1 < blocks.size(); i += 2)
+			{
+				func.blocks.emplace_hint(func.blocks.end(), blocks[i], blocks[i + 1]);
+			}
+
+			func.called_from.insert(calls.begin(), calls.end());
+		}
+
+		return true;
+	}
+
+	void save_analysis(const fs::file& file, const std::vector<ppu_function>& funcs)
+	{
+		file.write(s_analysis_magic);
+		file.write(s_analysis_version);
+		file.write(::size32(funcs));
+
+		for (const auto& func : funcs)
+		{
+			const u32 data[6]{func.addr, func.toc, func.size, static_cast<u32>(func.attr), func.stack_frame, func.gate_target};
+			file.write(data);
+
+			std::vector<u32> blocks;
+
+			for (const auto& block : func.blocks)
+			{
+				blocks.push_back(block.first);
+				blocks.push_back(block.second);
+			}
+
+			const std::vector<u32> calls(func.called_from.begin(), func.called_from.end());
+			file.write(::size32(func.blocks));
+			file.write(blocks);
+			file.write(::size32(calls));
+			file.write(calls);
+		}
+	}
+}
+
+std::vector<ppu_function> ppu_analyse(const std::vector<std::pair<u32, u32>>& segs, const std::vector<std::pair<u32, u32>>& secs, u32 lib_toc)
+{
+	std::string cache_path;
+
+	if (g_cfg_ppu_analysis_cache)
+	{
+		cache_path = get_analysis_cache_path(segs, secs, lib_toc);
+
+		std::vector<ppu_function> result;
+
+		if (const fs::file file{cache_path})
+		{
+			try
+			{
+				if (load_analysis(file, result))
+				{
+					LOG_NOTICE(PPU, "Function analysis: %zu functions (cached)", result.size());
+					return result;
+				}
+			}
+			catch (const std::exception&)
+			{
+			}
+
+			LOG_ERROR(PPU, "Invalid analysis cache file: %s", cache_path);
+		}
+	}
+
+	auto result = ppu_analyse_impl(segs, secs, lib_toc);
+
+	if (!cache_path.empty() && fs::create_path(fs::get_parent_dir(cache_path)))
+	{
+		if (const fs::file file{cache_path + ".tmp", fs::rewrite})
+		{
+			save_analysis(file, result);
+		}
+
+		fs::rename(cache_path + ".tmp", cache_path);
+	}
+
+	return result;
+}
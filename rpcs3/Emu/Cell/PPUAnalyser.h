@@ -106,6 +106,9 @@ extern void ppu_validate(const std::string& fname, const std::vector<ppu_functio
 
 extern std::vector<ppu_function> ppu_analyse(const std::vector<std::pair<u32, u32>>& segs, const std::vector<std::pair<u32, u32>>& secs, u32 lib_toc);
 
+// Run func(index) for each index in [0, count) on worker threads (the current thread participates)
+extern void ppu_parallel_for(u32 count, const std::function<void(u32)>& func);
+
 // PPU Instruction Type
 struct ppu_itype
 {
@@ -2,9 +2,31 @@
 #include "Emu/System.h"
 #include "PPUThread.h"
 #include "PPUInterpreter.h"
+#include "RawSPUThread.h"
 
 #include <cmath>
 
+// Word access with RawSPU MMIO check (the area is never mapped, avoids access violation)
+inline u32 ppu_read32(u32 addr)
+{
+	if (UNLIKELY(addr >= RAW_SPU_BASE_ADDR) && is_raw_spu_mmio(addr))
+	{
+		return raw_spu_mmio_read(addr);
+	}
+
+	return vm::ps3::read32(addr);
+}
+
+inline void ppu_write32(u32 addr, u32 value)
+{
+	if (UNLIKELY(addr >= RAW_SPU_BASE_ADDR) && is_raw_spu_mmio(addr))
+	{
+		return raw_spu_mmio_write(addr, value);
+	}
+
+	vm::ps3::write32(addr, value);
+}
+
 // TODO: fix rol8 and rol16 for __GNUG__ (probably with __asm__)
 inline u8 rol8(const u8 x, const u8 n) { return x << n | x >> (8 - n); }
 inline u16 rol16(const u16 x, const u16 n) { return x << n | x >> (16 - n); }
@@ -2292,7 +2314,7 @@ bool ppu_interpreter::LDX(ppu_thread& ppu, ppu_opcode_t op)
 bool ppu_interpreter::LWZX(ppu_thread& ppu, ppu_opcode_t op)
 {
 	const u64 addr = op.ra ? ppu.gpr[op.ra] + ppu.gpr[op.rb] : ppu.gpr[op.rb];
-	ppu.gpr[op.rd] = vm::read32(vm::cast(addr, HERE));
+	ppu.gpr[op.rd] = ppu_read32(vm::cast(addr, HERE));
 	return true;
 }
 
@@ -2378,7 +2400,7 @@ bool ppu_interpreter::DCBST(ppu_thread& ppu, ppu_opcode_t op)
 bool ppu_interpreter::LWZUX(ppu_thread& ppu, ppu_opcode_t op)
 {
 	const u64 addr = ppu.gpr[op.ra] + ppu.gpr[op.rb];
-	ppu.gpr[op.rd] = vm::read32(vm::cast(addr, HERE));
+	ppu.gpr[op.rd] = ppu_read32(vm::cast(addr, HERE));
 	ppu.gpr[op.ra] = addr;
 	return true;
 }
@@ -2579,7 +2601,7 @@ bool ppu_interpreter::STWCX(ppu_thread& ppu, ppu_opcode_t op)
 bool ppu_interpreter::STWX(ppu_thread& ppu, ppu_opcode_t op)
 {
 	const u64 addr = op.ra ? ppu.gpr[op.ra] + ppu.gpr[op.rb] : ppu.gpr[op.rb];
-	vm::write32(vm::cast(addr, HERE), (u32)ppu.gpr[op.rs]);
+	ppu_write32(vm::cast(addr, HERE), (u32)ppu.gpr[op.rs]);
 	return true;
 }
 
@@ -2602,7 +2624,7 @@ bool ppu_interpreter::STDUX(ppu_thread& ppu, ppu_opcode_t op)
 bool ppu_interpreter::STWUX(ppu_thread& ppu, ppu_opcode_t op)
 {
 	const u64 addr = ppu.gpr[op.ra] + ppu.gpr[op.rb];
-	vm::write32(vm::cast(addr, HERE), (u32)ppu.gpr[op.rs]);
+	ppu_write32(vm::cast(addr, HERE), (u32)ppu.gpr[op.rs]);
 	ppu.gpr[op.ra] = addr;
 	return true;
 }
@@ -3353,14 +3375,14 @@ bool ppu_interpreter::DCBZ(ppu_thread& ppu, ppu_opcode_t op)
 bool ppu_interpreter::LWZ(ppu_thread& ppu, ppu_opcode_t op)
 {
 	const u64 addr = op.ra ? ppu.gpr[op.ra] + op.simm16 : op.simm16;
-	ppu.gpr[op.rd] = vm::read32(vm::cast(addr, HERE));
+	ppu.gpr[op.rd] = ppu_read32(vm::cast(addr, HERE));
 	return true;
 }
 
 bool ppu_interpreter::LWZU(ppu_thread& ppu, ppu_opcode_t op)
 {
 	const u64 addr = ppu.gpr[op.ra] + op.simm16;
-	ppu.gpr[op.rd] = vm::read32(vm::cast(addr, HERE));
+	ppu.gpr[op.rd] = ppu_read32(vm::cast(addr, HERE));
 	ppu.gpr[op.ra] = addr;
 	return true;
 }
@@ -3383,14 +3405,14 @@ bool ppu_interpreter::LBZU(ppu_thread& ppu, ppu_opcode_t op)
 bool ppu_interpreter::STW(ppu_thread& ppu, ppu_opcode_t op)
 {
 	const u64 addr = op.ra ? ppu.gpr[op.ra] + op.simm16 : op.simm16;
-	vm::write32(vm::cast(addr, HERE), (u32)ppu.gpr[op.rs]);
+	ppu_write32(vm::cast(addr, HERE), (u32)ppu.gpr[op.rs]);
 	return true;
 }
 
 bool ppu_interpreter::STWU(ppu_thread& ppu, ppu_opcode_t op)
 {
 	const u64 addr = ppu.gpr[op.ra] + op.simm16;
-	vm::write32(vm::cast(addr, HERE), (u32)ppu.gpr[op.rs]);
+	ppu_write32(vm::cast(addr, HERE), (u32)ppu.gpr[op.rs]);
 	ppu.gpr[op.ra] = addr;
 	return true;
 }
@@ -2,13 +2,16 @@
 #include "Utilities/Config.h"
 #include "Utilities/AutoPause.h"
 #include "Crypto/sha1.h"
+#include "Crypto/unself.h"
 #include "Loader/ELF.h"
 #include "Emu/System.h"
 #include "Emu/IdManager.h"
+#include "Emu/Benchmark.h"
 
 #include "Emu/Cell/PPUOpcodes.h"
 #include "Emu/Cell/PPUModule.h"
 #include "Emu/Cell/PPUAnalyser.h"
+#include "Emu/Cell/PPUScheduler.h"
 
 #include "Emu/Cell/lv2/sys_prx.h"
 
@@ -116,6 +119,8 @@ extern std::string ppu_get_variable_name(const std::string& module, u32 vnid);
 
 extern void sys_initialize_tls(ppu_thread&, u64, u32, u32, u32);
 
+extern u64 get_system_time();
+
 extern u32 g_ps3_sdk_version;
 
 // Function lookup table. Not supposed to grow after emulation start.
@@ -146,6 +151,10 @@ extern void ppu_execute_function(ppu_thread& ppu, u32 index)
 
 		if (const auto func = g_ppu_function_cache[index])
 		{
+			if (UNLIKELY(g_perf_counters.enabled)) g_perf_counters.ppu_hle_calls++;
+
+			// HLE functions may wait, don't hold the execution slot
+			ppu_scheduler_scope sched_scope(ppu, false);
 			func(ppu);
 			LOG_TRACE(HLE, "'%s' finished, r3=0x%llx", ppu_get_module_function_name(index), ppu.gpr[3]);
 			return;
@@ -731,10 +740,21 @@ static void ppu_load_imports(const std::shared_ptr<ppu_linkage_info>& link, u32
 	}
 }
 
-std::shared_ptr<lv2_prx_t> ppu_load_prx(const ppu_prx_object& elf)
+// PRX image loaded, relocated and linked (the analysis is performed separately)
+struct ppu_prx_image
 {
+	std::shared_ptr<lv2_prx_t> prx;
 	std::vector<std::pair<u32, u32>> segments;
 	std::vector<std::pair<u32, u32>> sections;
+	u32 toc = 0;
+	bool has_info = false;
+};
+
+static ppu_prx_image ppu_link_prx(const ppu_prx_object& elf)
+{
+	ppu_prx_image image;
+	auto& segments = image.segments;
+	auto& sections = image.sections;
 
 	for (const auto& prog : elf.progs)
 	{
@@ -911,7 +931,8 @@ std::shared_ptr<lv2_prx_t> ppu_load_prx(const ppu_prx_object& elf)
 
 		ppu_load_imports(link, lib_info->imports_start, lib_info->imports_end);
 
-		prx->funcs = ppu_analyse(segments, sections, lib_info->toc);
+		image.toc = lib_info->toc;
+		image.has_info = true;
 	}
 	else
 	{
@@ -922,7 +943,20 @@ std::shared_ptr<lv2_prx_t> ppu_load_prx(const ppu_prx_object& elf)
 	prx->stop.set(prx->specials[0xab779874]);
 	prx->exit.set(prx->specials[0x3ab9a95e]);
 
-	return prx;
+	image.prx = std::move(prx);
+	return image;
+}
+
+std::shared_ptr<lv2_prx_t> ppu_load_prx(const ppu_prx_object& elf)
+{
+	const auto image = ppu_link_prx(elf);
+
+	if (image.has_info)
+	{
+		image.prx->funcs = ppu_analyse(image.segments, image.sections, image.toc);
+	}
+
+	return image.prx;
 }
 
 void ppu_load_exec(const ppu_exec_object& elf)
@@ -1102,55 +1136,121 @@ void ppu_load_exec(const ppu_exec_object& elf)
 	// Load modules
 	const std::string& lle_dir = vfs::get("/dev_flash/sys/external");
 
+	// Library files (liblv2 only provides the start function)
+	std::vector<std::string> lib_names;
+
 	if (g_cfg_load_liblv2)
 	{
-		const ppu_prx_object obj = fs::file(lle_dir + "/liblv2.sprx");
+		lib_names.emplace_back("liblv2.sprx");
+	}
+	else
+	{
+		const auto lib_set = g_cfg_load_libs.get_set();
+		lib_names.assign(lib_set.begin(), lib_set.end());
+	}
+
+	struct ppu_lib_load_info
+	{
+		ppu_prx_object obj;
+		ppu_prx_image image;
+		u64 decrypt_time = 0;
+		u64 analyse_time = 0;
+	};
+
+	std::vector<ppu_lib_load_info> libs(lib_names.size());
+
+	const u64 load_start = get_system_time();
+
+	// Decrypt and parse the files concurrently
+	ppu_parallel_for(::size32(libs), [&](u32 i)
+	{
+		const u64 start = get_system_time();
+		libs[i].obj = decrypt_self(fs::file(lle_dir + '/' + lib_names[i]));
+		libs[i].decrypt_time = get_system_time() - start;
+	});
+
+	const u64 link_start = get_system_time();
+
+	// Load and link in order (memory allocation and linkage info are shared)
+	for (u32 i = 0; i < libs.size(); i++)
+	{
+		const auto& name = lib_names[i];
+		const auto& obj = libs[i].obj;
 
 		if (obj == elf_error::ok)
 		{
-			start_funcs.push_back(ppu_load_prx(obj)->start.addr());
+			LOG_WARNING(LOADER, "Loading library: %s", name);
+
+			libs[i].image = ppu_link_prx(obj);
 		}
-		else
+		else if (g_cfg_load_liblv2)
 		{
 			fmt::throw_exception("Failed to load liblv2.sprx: %s", obj.get_error());
 		}
+		else
+		{
+			LOG_FATAL(LOADER, "Failed to load %s: %s", name, obj.get_error());
+		}
 	}
-	else
+
+	const u64 analyse_start = get_system_time();
+
+	// Analyse concurrently (reads the memory of the linked libraries only)
+	ppu_parallel_for(::size32(libs), [&](u32 i)
 	{
-		for (const auto& name : g_cfg_load_libs.get_set())
+		const auto& image = libs[i].image;
+
+		if (image.prx && image.has_info)
 		{
-			const ppu_prx_object obj = fs::file(lle_dir + '/' + name);
+			const u64 start = get_system_time();
+			image.prx->funcs = ppu_analyse(image.segments, image.sections, image.toc);
+			libs[i].analyse_time = get_system_time() - start;
+		}
+	});
 
-			if (obj == elf_error::ok)
-			{
-				LOG_WARNING(LOADER, "Loading library: %s", name);
+	const u64 load_end = get_system_time();
 
-				const auto prx = ppu_load_prx(obj);
+	for (u32 i = 0; i < libs.size(); i++)
+	{
+		const auto& name = lib_names[i];
+		const auto& prx = libs[i].image.prx;
 
-				// Register start function
-				if (prx->start)
-				{
-					start_funcs.push_back(prx->start.addr());
-				}
+		if (!prx)
+		{
+			continue;
+		}
 
-				// Add functions
-				exec_set.insert(exec_set.end(), prx->funcs.begin(), prx->funcs.end());
+		LOG_NOTICE(LOADER, "Library %s: decrypted in %.3f ms, analysed in %.3f ms", name, libs[i].decrypt_time / 1000., libs[i].analyse_time / 1000.);
 
-				if (prx->funcs.empty())
-				{
-					LOG_FATAL(LOADER, "Module %s has no functions!", name);
-				}
-				else
-				{
-					// TODO: fix arguments
-					ppu_validate(lle_dir + '/' + name, prx->funcs, prx->funcs[0].addr);
-				}
-			}
-			else
-			{
-				LOG_FATAL(LOADER, "Failed to load %s: %s", name, obj.get_error());
-			}
+		// Register start function
+		if (prx->start)
+		{
+			start_funcs.push_back(prx->start.addr());
+		}
+
+		if (g_cfg_load_liblv2)
+		{
+			continue;
+		}
+
+		// Add functions
+		exec_set.insert(exec_set.end(), prx->funcs.begin(), prx->funcs.end());
+
+		if (prx->funcs.empty())
+		{
+			LOG_FATAL(LOADER, "Module %s has no functions!", name);
 		}
+		else
+		{
+			// TODO: fix arguments
+			ppu_validate(lle_dir + '/' + name, prx->funcs, prx->funcs[0].addr);
+		}
+	}
+
+	if (!libs.empty())
+	{
+		LOG_NOTICE(LOADER, "Loaded %u libraries in %.3f ms (decryption: %.3f ms, linkage: %.3f ms, analysis: %.3f ms)", libs.size(),
+			(load_end - load_start) / 1000., (link_start - load_start) / 1000., (analyse_start - link_start) / 1000., (load_end - analyse_start) / 1000.);
 	}
 
 	// Check unlinked functions and variables
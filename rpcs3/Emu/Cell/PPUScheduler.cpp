@@ -0,0 +1,192 @@
+#include "stdafx.h"
+#include "Utilities/Config.h"
+#include "Emu/System.h"
+#include "Emu/IdManager.h"
+#include "PPUScheduler.h"
+
+#include <thread>
+#include <algorithm>
+
+extern u64 get_system_time();
+
+cfg::bool_entry g_cfg_ppu_scheduler(cfg::root.core, "PPU Thread Scheduler", false);
+cfg::int_entry<0, 64> g_cfg_ppu_scheduler_threads(cfg::root.core, "PPU Scheduler Threads", 0); // 0: host thread count
+
+// Time slice for threads of the same priority (us)
+static const u64 s_ppu_time_slice = 5000;
+
+ppu_scheduler::ppu_scheduler()
+	: m_max(g_cfg_ppu_scheduler_threads ? static_cast<u32>(g_cfg_ppu_scheduler_threads) : std::max<u32>(std::thread::hardware_concurrency(), 1))
+{
+	LOG_NOTICE(PPU, "PPU scheduler: %u threads", m_max);
+}
+
+ppu_scheduler::~ppu_scheduler()
+{
+	LOG_NOTICE(PPU, "PPU scheduler: %llu switches, %llu preemptions", m_switches, m_preemptions);
+}
+
+ppu_thread* ppu_scheduler::get_next() const
+{
+	ppu_thread* result = nullptr;
+
+	for (ppu_thread* ppu : m_ready)
+	{
+		if (!result || ppu->prio < result->prio || (ppu->prio == result->prio && ppu->sched_ticket < result->sched_ticket))
+		{
+			result = ppu;
+		}
+	}
+
+	return result;
+}
+
+void ppu_scheduler::preempt(ppu_thread& ppu, u64 waited)
+{
+	const u64 now = get_system_time();
+
+	// Find the lowest priority running thread (which has been running the longest)
+	ppu_thread* target = nullptr;
+
+	for (ppu_thread* cpu : m_running)
+	{
+		if (!target || cpu->prio > target->prio || (cpu->prio == target->prio && cpu->sched_stamp < target->sched_stamp))
+		{
+			target = cpu;
+		}
+	}
+
+	// Lower priority is replaced immediately, the same priority after the time slice
+	if (target && (target->prio > ppu.prio || (target->prio == ppu.prio && waited >= s_ppu_time_slice && now - target->sched_stamp >= s_ppu_time_slice)))
+	{
+		if (!target->state.test_and_set(cpu_flag::yield))
+		{
+			m_preemptions++;
+		}
+	}
+}
+
+void ppu_scheduler::acquire(ppu_thread& ppu)
+{
+	if (ppu.sched_running)
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	const u64 start = get_system_time();
+
+	ppu.sched_ticket = m_ticket++;
+	m_ready.push_back(&ppu);
+
+	while (m_running.size() >= m_max || get_next() != &ppu)
+	{
+		if (Emu.IsStopped() || test(ppu.state & cpu_flag::exit))
+		{
+			m_ready.erase(std::find(m_ready.begin(), m_ready.end(), &ppu));
+			ppu.sched_ready_time += get_system_time() - start;
+			m_cv.notify_all();
+			return;
+		}
+
+		if (get_next() == &ppu)
+		{
+			preempt(ppu, get_system_time() - start);
+		}
+
+		m_cv.wait_for(lock, std::chrono::milliseconds(1));
+	}
+
+	m_ready.erase(std::find(m_ready.begin(), m_ready.end(), &ppu));
+	m_running.push_back(&ppu);
+	m_switches++;
+
+	const u64 now = get_system_time();
+	ppu.sched_running = true;
+	ppu.sched_ready_time += now - start;
+	ppu.sched_stamp = now;
+
+	// Another thread may be scheduled as well
+	if (m_ready.size() && m_running.size() < m_max)
+	{
+		m_cv.notify_all();
+	}
+}
+
+void ppu_scheduler::release(ppu_thread& ppu)
+{
+	if (!ppu.sched_running)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_running.erase(std::find(m_running.begin(), m_running.end(), &ppu));
+
+	ppu.sched_running = false;
+	ppu.sched_run_time += get_system_time() - ppu.sched_stamp;
+	ppu.state -= cpu_flag::yield;
+
+	if (m_ready.size())
+	{
+		m_cv.notify_all();
+	}
+}
+
+void ppu_scheduler::yield(ppu_thread& ppu)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		ppu.state -= cpu_flag::yield;
+
+		if (m_ready.empty())
+		{
+			return;
+		}
+	}
+
+	ppu.sched_yields++;
+	release(ppu);
+	acquire(ppu);
+}
+
+ppu_scheduler_scope::ppu_scheduler_scope(ppu_thread& ppu, bool run)
+	: m_ppu(ppu)
+	, m_prev(ppu.sched_running)
+{
+	if (!g_cfg_ppu_scheduler || m_prev == run)
+	{
+		return;
+	}
+
+	m_sched = fxm::get_always<ppu_scheduler>();
+
+	if (run)
+	{
+		m_sched->acquire(ppu);
+	}
+	else
+	{
+		m_sched->release(ppu);
+	}
+}
+
+ppu_scheduler_scope::~ppu_scheduler_scope()
+{
+	if (!m_sched)
+	{
+		return;
+	}
+
+	if (m_prev)
+	{
+		m_sched->acquire(m_ppu);
+	}
+	else
+	{
+		m_sched->release(m_ppu);
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "PPUThread.h"
+
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+// Limits the amount of PPU threads executing guest code simultaneously (optional, must be PS3 process-local).
+// Threads give up the slot in syscalls and HLE functions, waiting threads are selected by guest priority.
+class ppu_scheduler
+{
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+
+	const u32 m_max; // Max threads executing guest code
+
+	std::vector<ppu_thread*> m_running;
+	std::vector<ppu_thread*> m_ready; // Threads waiting for the slot
+
+	u64 m_ticket = 0; // Ready queue order
+	u64 m_switches = 0;
+	u64 m_preemptions = 0;
+
+	// Get the ready thread which must be scheduled first (highest priority, FIFO otherwise)
+	ppu_thread* get_next() const;
+
+	// Request a running thread to yield if the waiting thread should replace it
+	void preempt(ppu_thread& ppu, u64 waited);
+
+public:
+	ppu_scheduler();
+	~ppu_scheduler();
+
+	// Get execution slot (waits, returns without the slot if the thread or the emulation is stopping)
+	void acquire(ppu_thread& ppu);
+
+	// Release execution slot
+	void release(ppu_thread& ppu);
+
+	// Give up the slot if there are waiting threads (cpu_flag::yield)
+	void yield(ppu_thread& ppu);
+};
+
+// Set the scheduling state of the PPU thread for the scope (run: executing guest code)
+class ppu_scheduler_scope
+{
+	ppu_thread& m_ppu;
+	std::shared_ptr<ppu_scheduler> m_sched;
+	bool m_prev;
+
+public:
+	ppu_scheduler_scope(ppu_thread& ppu, bool run);
+	~ppu_scheduler_scope();
+
+	ppu_scheduler_scope(const ppu_scheduler_scope&) = delete;
+};
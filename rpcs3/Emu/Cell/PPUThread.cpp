@@ -4,10 +4,13 @@
 #include "Emu/Memory/Memory.h"
 #include "Emu/System.h"
 #include "Emu/IdManager.h"
+#include "Emu/Benchmark.h"
 #include "PPUThread.h"
 #include "PPUInterpreter.h"
 #include "PPUAnalyser.h"
 #include "PPUModule.h"
+#include "PPUScheduler.h"
+#include "RawSPUThread.h"
 
 #ifdef LLVM_AVAILABLE
 #ifdef _MSC_VER
@@ -82,6 +85,11 @@ std::string ppu_thread::dump() const
 {
 	std::string ret = cpu_thread::dump();
 	ret += fmt::format("Priority: %d\n", prio);
+
+	if (sched_run_time || sched_ready_time)
+	{
+		ret += fmt::format("Scheduler: run=%.3fms, ready=%.3fms, yields=%llu\n", sched_run_time / 1000., sched_ready_time / 1000., sched_yields);
+	}
 	
 	ret += "\nRegisters:\n=========\n";
 	for (uint i = 0; i < 32; ++i) ret += fmt::format("GPR[%d] = 0x%llx\n", i, gpr[i]);
@@ -181,6 +189,9 @@ void ppu_thread::cpu_task()
 
 void ppu_thread::exec_task()
 {
+	// Guest code is executed (may wait for the scheduler)
+	ppu_scheduler_scope sched_scope(*this, true);
+
 	if (g_cfg_ppu_decoder.get() == ppu_decoder_type::llvm)
 	{
 		return reinterpret_cast<ppu_function_t>((std::uintptr_t)s_ppu_compiled[cia / 4])(*this);
@@ -201,6 +212,11 @@ void ppu_thread::exec_task()
 	{
 		if (UNLIKELY(test(state)))
 		{
+			if (test(state, cpu_flag::yield))
+			{
+				fxm::get_always<ppu_scheduler>()->yield(*this);
+			}
+
 			if (check_state()) return;
 		}
 
@@ -246,6 +262,11 @@ void ppu_thread::exec_task()
 
 ppu_thread::~ppu_thread()
 {
+	if (sched_run_time || sched_ready_time)
+	{
+		LOG_NOTICE(PPU, "Thread '%s': run %.3f ms, waited %.3f ms for the scheduler, yielded %llu times", m_name, sched_run_time / 1000., sched_ready_time / 1000., sched_yields);
+	}
+
 	if (stack_addr)
 	{
 		vm::dealloc_verbose_nothrow(stack_addr, vm::stack);
@@ -449,22 +470,13 @@ void ppu_thread::stack_pop_verbose(u32 addr, u32 size) noexcept
 
 const ppu_decoder<ppu_itype> s_ppu_itype;
 
+extern u64 get_system_time();
 extern u64 get_timebased_time();
 extern ppu_function_t ppu_get_syscall(u64 code);
 extern std::string ppu_get_syscall_name(u64 code);
 extern ppu_function_t ppu_get_function(u32 index);
 extern std::string ppu_get_module_function_name(u32 index);
 
-extern __m128 sse_exp2_ps(__m128 A);
-extern __m128 sse_log2_ps(__m128 A);
-extern __m128i sse_altivec_vperm(__m128i A, __m128i B, __m128i C);
-extern __m128i sse_altivec_lvsl(u64 addr);
-extern __m128i sse_altivec_lvsr(u64 addr);
-extern __m128i sse_cellbe_lvlx(u64 addr);
-extern __m128i sse_cellbe_lvrx(u64 addr);
-extern void sse_cellbe_stvlx(u64 addr, __m128i a);
-extern void sse_cellbe_stvrx(u64 addr, __m128i a);
-
 [[noreturn]] static void ppu_trap(u64 addr)
 {
 	fmt::throw_exception("Trap! (0x%llx)", addr);
@@ -494,6 +506,26 @@ static u64 ppu_ldarx(u32 addr)
 	return reg_value;
 }
 
+static u32 ppu_mmio_read32(u32 addr)
+{
+	if (is_raw_spu_mmio(addr))
+	{
+		return raw_spu_mmio_read(addr);
+	}
+
+	return vm::read32(addr);
+}
+
+static void ppu_mmio_write32(u32 addr, u32 value)
+{
+	if (is_raw_spu_mmio(addr))
+	{
+		return raw_spu_mmio_write(addr, value);
+	}
+
+	vm::write32(addr, value);
+}
+
 static bool ppu_stwcx(u32 addr, u32 reg_value)
 {
 	const be_t<u32> data = reg_value;
@@ -506,17 +538,6 @@ static bool ppu_stdcx(u32 addr, u64 reg_value)
 	return vm::reservation_update(addr, &data, sizeof(data));
 }
 
-static bool adde_carry(u64 a, u64 b, bool c)
-{
-#ifdef _MSC_VER
-	return _addcarry_u64(c, a, b, nullptr) != 0;
-#else
-	bool result;
-	__asm__("addb $0xff, %[c] \n adcq %[a], %[b] \n setb %[result]" : [a] "+&r" (a), [b] "+&r" (b), [c] "+&r" (c), [result] "=r" (result));
-	return result;
-#endif
-}
-
 static void ppu_initialize()
 {
 	const auto _funcs = fxm::get_always<std::vector<ppu_function>>();
@@ -548,21 +569,15 @@ static void ppu_initialize()
 		{ "__ldarx", (u64)&ppu_ldarx },
 		{ "__stwcx", (u64)&ppu_stwcx },
 		{ "__stdcx", (u64)&ppu_stdcx },
-		{ "__adde_get_ca", (u64)&adde_carry },
-		{ "__vexptefp", (u64)&sse_exp2_ps },
-		{ "__vlogefp", (u64)&sse_log2_ps },
-		{ "__vperm", (u64)&sse_altivec_vperm },
-		{ "__lvsl", (u64)&sse_altivec_lvsl },
-		{ "__lvsr", (u64)&sse_altivec_lvsr },
-		{ "__lvlx", (u64)&sse_cellbe_lvlx },
-		{ "__lvrx", (u64)&sse_cellbe_lvrx },
-		{ "__stvlx", (u64)&sse_cellbe_stvlx },
-		{ "__stvrx", (u64)&sse_cellbe_stvrx },
+		{ "__mmio_read32", (u64)&ppu_mmio_read32 },
+		{ "__mmio_write32", (u64)&ppu_mmio_write32 },
 	};
 
 #ifdef LLVM_AVAILABLE
 	using namespace llvm;
 
+	const u64 compile_start = get_system_time();
+
 	// Create LLVM module
 	std::unique_ptr<Module> module = std::make_unique<Module>("", g_llvm_ctx);
 
@@ -794,6 +809,8 @@ static void ppu_initialize()
 		}
 	}
 
+	g_perf_counters.ppu_compile_time += get_system_time() - compile_start;
+
 	LOG_SUCCESS(PPU, "LLVM: Compilation finished (%s)", sys::getHostCPUName().data());
 #endif
 }
@@ -123,6 +123,14 @@ public:
 	bool is_joinable = true;
 	bool is_joining = false;
 
+	// PPU scheduler state (see ppu_scheduler)
+	bool sched_running = false; // Holds the execution slot
+	u64 sched_ticket = 0; // Ready queue order
+	u64 sched_stamp = 0; // Time the slot was acquired
+	u64 sched_run_time = 0; // Time spent executing guest code (us)
+	u64 sched_ready_time = 0; // Time spent waiting for the slot (us)
+	u64 sched_yields = 0; // Slot given up on request
+
 	lf_fifo<atomic_t<cmd64>, 255> cmd_queue; // Command queue for asynchronous operations.
 
 	void cmd_push(cmd64);
@@ -3,6 +3,9 @@
 #include "PPUTranslator.h"
 #include "PPUThread.h"
 #include "PPUInterpreter.h"
+#include "SPUThread.h"
+
+#include "llvm/IR/MDBuilder.h"
 
 #include "../Utilities/Log.h"
 
@@ -132,17 +135,16 @@ Function* PPUTranslator::TranslateToIR(const ppu_function& info, be_t<u32>* bin,
 	m_g_gpr[1] = m_ir->CreateConstGEP2_32(nullptr, m_thread, 0, 1 + 1, ".spg");
 	m_g_gpr[2] = m_ir->CreateConstGEP2_32(nullptr, m_thread, 0, 1 + 2, ".rtoc");
 	m_g_gpr[13] = m_ir->CreateConstGEP2_32(nullptr, m_thread, 0, 1 + 13, ".tls");
-	m_gpr[1] = m_ir->CreateAlloca(GetType<u64>(), nullptr, ".sp");
 
 	// Registers used for args or results (TODO)
 	for (u32 i = 3; i <= 10; i++) m_g_gpr[i] = m_ir->CreateConstGEP2_32(nullptr, m_thread, 0, 1 + i, fmt::format(".r%u", i));
 	for (u32 i = 1; i <= 13; i++) m_g_fpr[i] = m_ir->CreateConstGEP2_32(nullptr, m_thread, 0, 33 + i, fmt::format(".f%u", i));
 	for (u32 i = 2; i <= 13; i++) m_g_vr[i] = m_ir->CreateConstGEP2_32(nullptr, m_thread, 0, 65 + i, fmt::format(".v%u", i));
 
-	/* Create local variables */
-	for (u32 i = 0; i < 32; i++) if (!m_gpr[i]) m_gpr[i] = m_g_gpr[i] ? m_g_gpr[i] : m_ir->CreateAlloca(GetType<u64>(), nullptr, fmt::format(".r%d", i));
-	for (u32 i = 0; i < 32; i++) if (!m_fpr[i]) m_fpr[i] = m_g_fpr[i] ? m_g_fpr[i] : m_ir->CreateAlloca(GetType<f64>(), nullptr, fmt::format(".f%d", i));
-	for (u32 i = 0; i < 32; i++) if (!m_vr[i]) m_vr[i] = m_g_vr[i] ? m_g_vr[i] : m_ir->Insert(new AllocaInst(GetType<u32[4]>(), nullptr, 16, fmt::format(".v%d", i)));
+	/* Create local variables (context registers are only accessed at call boundaries) */
+	for (u32 i = 0; i < 32; i++) m_gpr[i] = m_ir->CreateAlloca(GetType<u64>(), nullptr, fmt::format(".r%d", i));
+	for (u32 i = 0; i < 32; i++) m_fpr[i] = m_ir->CreateAlloca(GetType<f64>(), nullptr, fmt::format(".f%d", i));
+	for (u32 i = 0; i < 32; i++) m_vr[i] = m_ir->Insert(new AllocaInst(GetType<u32[4]>(), nullptr, 16, fmt::format(".v%d", i)));
 
 	for (u32 i = 0; i < 32; i++)
 	{
@@ -202,7 +204,7 @@ Function* PPUTranslator::TranslateToIR(const ppu_function& info, be_t<u32>* bin,
 	//m_fpscr_rnl = m_fpscr[31] = m_ir->CreateAlloca(GetType<bool>(), nullptr, "fpscr.rn.lsb");
 
 	/* Initialize local variables */
-	m_ir->CreateStore(m_ir->CreateLoad(m_g_gpr[1]), m_gpr[1]); // SP
+	ReloadRegisters();
 	m_ir->CreateStore(m_ir->getFalse(), m_xer_so); // XER.SO
 	m_ir->CreateStore(m_ir->getFalse(), m_vscr_sat); // VSCR.SAT
 	m_ir->CreateStore(m_ir->getTrue(), m_vscr_nj);
@@ -312,6 +314,8 @@ void PPUTranslator::CallFunction(u64 target, bool tail, Value* indirect)
 
 	const auto callee_type = func ? m_func_types[target] : nullptr;
 
+	FlushRegisters();
+
 	if (func)
 	{
 		m_ir->CreateCall(func, {m_thread});
@@ -326,6 +330,7 @@ void PPUTranslator::CallFunction(u64 target, bool tail, Value* indirect)
 
 	if (!tail)
 	{
+		ReloadRegisters();
 		UndefineVolatileRegisters();
 	}
 
@@ -335,6 +340,28 @@ void PPUTranslator::CallFunction(u64 target, bool tail, Value* indirect)
 	}
 }
 
+void PPUTranslator::FlushRegisters()
+{
+	for (u32 i = 0; i < 96; i++)
+	{
+		if (m_globals[i])
+		{
+			m_ir->CreateStore(m_ir->CreateLoad(m_locals[i]), m_globals[i]);
+		}
+	}
+}
+
+void PPUTranslator::ReloadRegisters()
+{
+	for (u32 i = 0; i < 96; i++)
+	{
+		if (m_globals[i])
+		{
+			m_ir->CreateStore(m_ir->CreateLoad(m_globals[i]), m_locals[i]);
+		}
+	}
+}
+
 void PPUTranslator::UndefineVolatileRegisters()
 {
 	const auto undef_i64 = GetUndef<u64>();
@@ -581,6 +608,98 @@ void PPUTranslator::WriteMemory(Value* addr, Value* value, bool is_be, u32 align
 	m_ir->CreateAlignedStore(value, GetMemory(addr, value->getType()), align, true);
 }
 
+bool PPUTranslator::MayAccessMmio(Value* addr, u32 ra)
+{
+	if (const auto _const = dyn_cast<ConstantInt>(addr))
+	{
+		return static_cast<u32>(_const->getZExtValue()) - RAW_SPU_BASE_ADDR < 6 * RAW_SPU_OFFSET;
+	}
+
+	// Stack pointer, TOC and TLS pointer never point to RawSPU
+	return ra != 1 && ra != 2 && ra != 13;
+}
+
+Value* PPUTranslator::ReadWord(Value* addr, u32 ra)
+{
+	if (!MayAccessMmio(addr, ra))
+	{
+		return ReadMemory(addr, GetType<u32>());
+	}
+
+	// Check RawSPU area (unlikely), the problem state is handled by the function
+	const auto cond = m_ir->CreateICmpULT(m_ir->CreateSub(Trunc(addr, GetType<u32>()), m_ir->getInt32(RAW_SPU_BASE_ADDR)), m_ir->getInt32(6 * RAW_SPU_OFFSET));
+	const auto _mmio = BasicBlock::Create(m_context, fmt::format("loc_%llx.mmio", m_current_addr), m_function);
+	const auto _mem = BasicBlock::Create(m_context, fmt::format("loc_%llx.mem", m_current_addr), m_function);
+	const auto _next = BasicBlock::Create(m_context, fmt::format("loc_%llx.next", m_current_addr), m_function);
+	m_ir->CreateCondBr(cond, _mmio, _mem, MDBuilder(m_context).createBranchWeights(1, 1000));
+
+	m_ir->SetInsertPoint(_mmio);
+	const auto mmio_value = Call(GetType<u32>(), "__mmio_read32", Trunc(addr, GetType<u32>()));
+	m_ir->CreateBr(_next);
+
+	m_ir->SetInsertPoint(_mem);
+	const auto mem_value = ReadMemory(addr, GetType<u32>());
+	m_ir->CreateBr(_next);
+
+	m_ir->SetInsertPoint(_next);
+	const auto result = m_ir->CreatePHI(GetType<u32>(), 2);
+	result->addIncoming(mmio_value, _mmio);
+	result->addIncoming(mem_value, _mem);
+	return result;
+}
+
+void PPUTranslator::WriteWord(Value* addr, Value* value, u32 ra)
+{
+	if (!MayAccessMmio(addr, ra))
+	{
+		return WriteMemory(addr, value);
+	}
+
+	const auto cond = m_ir->CreateICmpULT(m_ir->CreateSub(Trunc(addr, GetType<u32>()), m_ir->getInt32(RAW_SPU_BASE_ADDR)), m_ir->getInt32(6 * RAW_SPU_OFFSET));
+	const auto _mmio = BasicBlock::Create(m_context, fmt::format("loc_%llx.mmio", m_current_addr), m_function);
+	const auto _mem = BasicBlock::Create(m_context, fmt::format("loc_%llx.mem", m_current_addr), m_function);
+	const auto _next = BasicBlock::Create(m_context, fmt::format("loc_%llx.next", m_current_addr), m_function);
+	m_ir->CreateCondBr(cond, _mmio, _mem, MDBuilder(m_context).createBranchWeights(1, 1000));
+
+	m_ir->SetInsertPoint(_mmio);
+	Call(GetType<void>(), "__mmio_write32", Trunc(addr, GetType<u32>()), value);
+	m_ir->CreateBr(_next);
+
+	m_ir->SetInsertPoint(_mem);
+	WriteMemory(addr, value);
+	m_ir->CreateBr(_next);
+
+	m_ir->SetInsertPoint(_next);
+}
+
+Value* PPUTranslator::GetShiftVector(Value* addr)
+{
+	static const u8 s_lvsl_base[16] = { 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 };
+
+	// Host byte i = (addr & 15) + 15 - i
+	const auto sh = Broadcast(m_ir->CreateTrunc(m_ir->CreateAnd(addr, 15), GetType<u8>()), 16);
+	return m_ir->CreateAdd(sh, ConstantDataVector::get(m_context, s_lvsl_base));
+}
+
+std::pair<Value*, Value*> PPUTranslator::GetShiftMasks(Value* addr)
+{
+	// Indices above 15 belong to the next quadword (LVLX), the rest to the previous one (LVRX)
+	const auto sh = GetShiftVector(addr);
+	const auto lmask = m_ir->CreateOr(sh, SExt(m_ir->CreateICmpUGT(sh, Broadcast(m_ir->getInt8(15), 16)), GetType<u8[16]>()));
+	const auto rmask = m_ir->CreateOr(sh, SExt(m_ir->CreateICmpULE(sh, Broadcast(m_ir->getInt8(15), 16)), GetType<u8[16]>()));
+	return{lmask, rmask};
+}
+
+std::pair<Value*, Value*> PPUTranslator::AddWithCarry(Value* a, Value* b, Value* c)
+{
+	const auto type = a->getType();
+	const auto name = fmt::format("llvm.uadd.with.overflow.i%u", type->getPrimitiveSizeInBits());
+	const auto rtype = StructType::get(m_context, {type, GetType<bool>()});
+	const auto r1 = Call(rtype, m_pure_attr, name, a, b);
+	const auto r2 = Call(rtype, m_pure_attr, name, m_ir->CreateExtractValue(r1, {0}), ZExt(c, type));
+	return{m_ir->CreateExtractValue(r2, {0}), m_ir->CreateOr(m_ir->CreateExtractValue(r1, {1}), m_ir->CreateExtractValue(r2, {1}))};
+}
+
 void PPUTranslator::CompilationError(const std::string& error)
 {
 	LOG_ERROR(PPU, "[0x%08llx] 0x%08llx: Error: %s", m_start_addr, m_current_addr, error);
@@ -882,12 +1001,40 @@ void PPUTranslator::VCTUXS(ppu_opcode_t op)
 
 void PPUTranslator::VEXPTEFP(ppu_opcode_t op)
 {
-	SetVr(op.vd, Call(GetType<f32[4]>(), m_pure_attr, "__vexptefp", GetVr(op.vb, VrType::vf)));
+	const auto fc = [&](f32 v) { return Broadcast(ConstantFP::get(GetType<f32>(), v), 4); };
+	const auto ic = [&](s32 v) { return Broadcast(m_ir->getInt32(v), 4); };
+
+	// Same approximation as the interpreter (sse_exp2_ps), including rcpps precision
+	const auto x0 = Call(GetType<f32[4]>(), m_pure_attr, "llvm.x86.sse.max.ps", Call(GetType<f32[4]>(), m_pure_attr, "llvm.x86.sse.min.ps", GetVr(op.vb, VrType::vf), fc(127.4999961f)), fc(-127.4999961f));
+	const auto x1 = m_ir->CreateFAdd(x0, fc(0.5f));
+	const auto x2 = m_ir->CreateSub(Call(GetType<s32[4]>(), m_pure_attr, "llvm.x86.sse2.cvtps2dq", x1), ZExt(m_ir->CreateFCmpUGE(fc(0.0f), x1), GetType<s32[4]>()));
+	const auto x3 = m_ir->CreateFSub(x0, m_ir->CreateSIToFP(x2, GetType<f32[4]>()));
+	const auto x4 = m_ir->CreateFMul(x3, x3);
+	const auto x5 = m_ir->CreateFMul(x3, m_ir->CreateFAdd(m_ir->CreateFMul(m_ir->CreateFAdd(m_ir->CreateFMul(x4, fc(0.023093347705f)), fc(20.20206567f)), x4), fc(1513.906801f)));
+	const auto x6 = m_ir->CreateFMul(x5, Call(GetType<f32[4]>(), m_pure_attr, "llvm.x86.sse.rcp.ps", m_ir->CreateFSub(m_ir->CreateFAdd(m_ir->CreateFMul(fc(233.1842117f), x4), fc(4368.211667f)), x5)));
+	const auto x7 = m_ir->CreateBitCast(m_ir->CreateShl(m_ir->CreateAdd(x2, ic(127)), 23), GetType<f32[4]>());
+	SetVr(op.vd, m_ir->CreateFMul(m_ir->CreateFAdd(m_ir->CreateFAdd(x6, x6), fc(1.0f)), x7));
 }
 
 void PPUTranslator::VLOGEFP(ppu_opcode_t op)
 {
-	SetVr(op.vd, Call(GetType<f32[4]>(), m_pure_attr, "__vlogefp", GetVr(op.vb, VrType::vf)));
+	const auto fc = [&](f32 v) { return Broadcast(ConstantFP::get(GetType<f32>(), v), 4); };
+	const auto ic = [&](s32 v) { return Broadcast(m_ir->getInt32(v), 4); };
+	const auto _1 = fc(1.0f);
+	const auto _c = fc(1.442695040f);
+
+	// Same approximation as the interpreter (sse_log2_ps), including rcpps precision
+	const auto x0 = Call(GetType<f32[4]>(), m_pure_attr, "llvm.x86.sse.max.ps", GetVr(op.vb, VrType::vf), m_ir->CreateBitCast(ic(0x00800000), GetType<f32[4]>()));
+	const auto x0i = m_ir->CreateBitCast(x0, GetType<s32[4]>());
+	const auto x1 = m_ir->CreateBitCast(m_ir->CreateOr(m_ir->CreateAnd(x0i, ic(0x807fffff)), m_ir->CreateBitCast(_1, GetType<s32[4]>())), GetType<f32[4]>());
+	const auto x2 = Call(GetType<f32[4]>(), m_pure_attr, "llvm.x86.sse.rcp.ps", m_ir->CreateFAdd(x1, _1));
+	const auto x3 = m_ir->CreateFMul(m_ir->CreateFSub(x1, _1), x2);
+	const auto x4 = m_ir->CreateFAdd(x3, x3);
+	const auto x5 = m_ir->CreateFMul(x4, x4);
+	const auto x6 = m_ir->CreateFAdd(m_ir->CreateFMul(m_ir->CreateFAdd(m_ir->CreateFMul(fc(-0.7895802789f), x5), fc(16.38666457f)), x5), fc(-64.1409953f));
+	const auto x7 = Call(GetType<f32[4]>(), m_pure_attr, "llvm.x86.sse.rcp.ps", m_ir->CreateFAdd(m_ir->CreateFMul(m_ir->CreateFAdd(m_ir->CreateFMul(fc(-35.67227983f), x5), fc(312.0937664f)), x5), fc(-769.6919436f)));
+	const auto x8 = m_ir->CreateSIToFP(m_ir->CreateSub(m_ir->CreateLShr(x0i, 23), ic(127)), GetType<f32[4]>());
+	SetVr(op.vd, m_ir->CreateFAdd(m_ir->CreateFMul(m_ir->CreateFMul(m_ir->CreateFMul(m_ir->CreateFMul(x5, x6), x7), x4), _c), m_ir->CreateFAdd(m_ir->CreateFMul(x4, _c), x8)));
 }
 
 void PPUTranslator::VMADDFP(ppu_opcode_t op)
@@ -1181,7 +1328,12 @@ void PPUTranslator::VOR(ppu_opcode_t op)
 void PPUTranslator::VPERM(ppu_opcode_t op)
 {
 	const auto abc = GetVrs(VrType::vi8, op.va, op.vb, op.vc);
-	SetVr(op.vd, Call(GetType<u8[16]>(), m_pure_attr, "__vperm", abc[0], abc[1], abc[2]));
+
+	// Host byte index (31 - c) selects va if it's above 15, pshufb only uses the low 4 bits
+	const auto index = m_ir->CreateAnd(m_ir->CreateNot(abc[2]), Broadcast(m_ir->getInt8(0x1f), 16));
+	const auto sa = Call(GetType<u8[16]>(), m_pure_attr, "llvm.x86.ssse3.pshuf.b.128", abc[0], index);
+	const auto sb = Call(GetType<u8[16]>(), m_pure_attr, "llvm.x86.ssse3.pshuf.b.128", abc[1], index);
+	SetVr(op.vd, m_ir->CreateSelect(m_ir->CreateICmpUGT(index, Broadcast(m_ir->getInt8(0xf), 16)), sa, sb));
 }
 
 void PPUTranslator::VPKPX(ppu_opcode_t op)
@@ -1752,13 +1904,17 @@ void PPUTranslator::BC(ppu_opcode_t op)
 
 void PPUTranslator::HACK(ppu_opcode_t op)
 {
+	FlushRegisters();
 	Call(GetType<void>(), "__hlecall", m_thread, m_ir->getInt32(op.opcode & 0x3ffffff));
+	ReloadRegisters();
 	UndefineVolatileRegisters();
 }
 
 void PPUTranslator::SC(ppu_opcode_t op)
 {
+	FlushRegisters();
 	Call(GetType<void>(), fmt::format(op.lev == 0 ? "__syscall" : "__lv%ucall", +op.lev), m_thread, m_ir->CreateLoad(m_gpr[11]));
+	ReloadRegisters();
 	UndefineVolatileRegisters();
 }
 
@@ -1808,6 +1964,7 @@ void PPUTranslator::BCLR(ppu_opcode_t op)
 	else
 	{
 		// Simple return
+		FlushRegisters();
 		m_ir->CreateRetVoid();
 	}
 }
@@ -2235,7 +2392,7 @@ void PPUTranslator::TW(ppu_opcode_t op)
 
 void PPUTranslator::LVSL(ppu_opcode_t op)
 {
-	SetVr(op.vd, Call(GetType<u8[16]>(), m_pure_attr, "__lvsl", op.ra ? m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb)) : GetGpr(op.rb)));
+	SetVr(op.vd, GetShiftVector(op.ra ? m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb)) : GetGpr(op.rb)));
 }
 
 void PPUTranslator::LVEBX(ppu_opcode_t op)
@@ -2334,7 +2491,7 @@ void PPUTranslator::LDX(ppu_opcode_t op)
 
 void PPUTranslator::LWZX(ppu_opcode_t op)
 {
-	SetGpr(op.rd, ReadMemory(op.ra ? m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb)) : GetGpr(op.rb), GetType<u32>()));
+	SetGpr(op.rd, ReadWord(op.ra ? m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb)) : GetGpr(op.rb), 0));
 }
 
 void PPUTranslator::SLW(ppu_opcode_t op)
@@ -2376,7 +2533,11 @@ void PPUTranslator::CMPL(ppu_opcode_t op)
 
 void PPUTranslator::LVSR(ppu_opcode_t op)
 {
-	SetVr(op.vd, Call(GetType<u8[16]>(), m_pure_attr, "__lvsr", op.ra ? m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb)) : GetGpr(op.rb)));
+	static const u8 s_lvsr_base[16] = { 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16 };
+
+	const auto addr = op.ra ? m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb)) : GetGpr(op.rb);
+	const auto sh = Broadcast(m_ir->CreateTrunc(m_ir->CreateAnd(addr, 15), GetType<u8>()), 16);
+	SetVr(op.vd, m_ir->CreateSub(ConstantDataVector::get(m_context, s_lvsr_base), sh));
 }
 
 void PPUTranslator::LVEHX(ppu_opcode_t op)
@@ -2410,7 +2571,7 @@ void PPUTranslator::DCBST(ppu_opcode_t op)
 void PPUTranslator::LWZUX(ppu_opcode_t op)
 {
 	const auto addr = m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb));
-	SetGpr(op.rd, ReadMemory(addr, GetType<u32>()));
+	SetGpr(op.rd, ReadWord(addr, 0));
 	SetGpr(op.ra, addr);
 }
 
@@ -2512,10 +2673,10 @@ void PPUTranslator::SUBFE(ppu_opcode_t op)
 	const auto a = m_ir->CreateNot(GetGpr(op.ra));
 	const auto b = GetGpr(op.rb);
 	const auto c = GetCarry();
-	const auto result = m_ir->CreateAdd(m_ir->CreateAdd(a, b), ZExt(c, GetType<u64>()));
-	SetGpr(op.rd, result);
-	SetCarry(Call(GetType<bool>(), m_pure_attr, "__adde_get_ca", a, b, c)); // TODO
-	if (op.rc) SetCrFieldSignedCmp(0, result, m_ir->getInt64(0));
+	const auto result = AddWithCarry(a, b, c);
+	SetGpr(op.rd, result.first);
+	SetCarry(result.second);
+	if (op.rc) SetCrFieldSignedCmp(0, result.first, m_ir->getInt64(0));
 	if (op.oe) SetOverflow(Call(GetType<bool>(), m_pure_attr, "__subfe_get_ov", a, b, c));
 }
 
@@ -2524,10 +2685,10 @@ void PPUTranslator::ADDE(ppu_opcode_t op)
 	const auto a = GetGpr(op.ra);
 	const auto b = GetGpr(op.rb);
 	const auto c = GetCarry();
-	const auto result = m_ir->CreateAdd(m_ir->CreateAdd(a, b), ZExt(c, GetType<u64>()));
-	SetGpr(op.rd, result);
-	SetCarry(Call(GetType<bool>(), m_pure_attr, "__adde_get_ca", a, b, c)); // TODO
-	if (op.rc) SetCrFieldSignedCmp(0, result, m_ir->getInt64(0));
+	const auto result = AddWithCarry(a, b, c);
+	SetGpr(op.rd, result.first);
+	SetCarry(result.second);
+	if (op.rc) SetCrFieldSignedCmp(0, result.first, m_ir->getInt64(0));
 	if (op.oe) SetOverflow(Call(GetType<bool>(), m_pure_attr, "__adde_get_ov", a, b, c));
 }
 
@@ -2576,7 +2737,7 @@ void PPUTranslator::STWCX(ppu_opcode_t op)
 
 void PPUTranslator::STWX(ppu_opcode_t op)
 {
-	WriteMemory(op.ra ? m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb)) : GetGpr(op.rb), GetGpr(op.rs, 32));
+	WriteWord(op.ra ? m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb)) : GetGpr(op.rb), GetGpr(op.rs, 32), 0);
 }
 
 void PPUTranslator::STVEHX(ppu_opcode_t op)
@@ -2595,7 +2756,7 @@ void PPUTranslator::STDUX(ppu_opcode_t op)
 void PPUTranslator::STWUX(ppu_opcode_t op)
 {
 	const auto addr = m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb));
-	WriteMemory(addr, GetGpr(op.rs, 32));
+	WriteWord(addr, GetGpr(op.rs, 32), 0);
 	SetGpr(op.ra, addr);
 }
 
@@ -2937,7 +3098,9 @@ void PPUTranslator::DIVW(ppu_opcode_t op)
 
 void PPUTranslator::LVLX(ppu_opcode_t op)
 {
-	SetVr(op.vd, Call(GetType<u8[16]>(), "__lvlx", op.ra ? m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb)) : GetGpr(op.rb)));
+	const auto addr = op.ra ? m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb)) : GetGpr(op.rb);
+	const auto data = ReadMemory(m_ir->CreateAnd(addr, -16), GetType<u8[16]>(), m_is_be, 16);
+	SetVr(op.vd, Call(GetType<u8[16]>(), m_pure_attr, "llvm.x86.ssse3.pshuf.b.128", data, GetShiftMasks(addr).first));
 }
 
 void PPUTranslator::LDBRX(ppu_opcode_t op)
@@ -2980,7 +3143,9 @@ void PPUTranslator::SRD(ppu_opcode_t op)
 
 void PPUTranslator::LVRX(ppu_opcode_t op)
 {
-	SetVr(op.vd, Call(GetType<u8[16]>(), "__lvrx", op.ra ? m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb)) : GetGpr(op.rb)));
+	const auto addr = op.ra ? m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb)) : GetGpr(op.rb);
+	const auto data = ReadMemory(m_ir->CreateAnd(addr, -16), GetType<u8[16]>(), m_is_be, 16);
+	SetVr(op.vd, Call(GetType<u8[16]>(), m_pure_attr, "llvm.x86.ssse3.pshuf.b.128", data, GetShiftMasks(addr).second));
 }
 
 void PPUTranslator::LSWI(ppu_opcode_t op)
@@ -3014,7 +3179,10 @@ void PPUTranslator::LFDUX(ppu_opcode_t op)
 
 void PPUTranslator::STVLX(ppu_opcode_t op)
 {
-	Call(GetType<void>(), "__stvlx", op.ra ? m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb)) : GetGpr(op.rb), GetVr(op.vs, VrType::vi8));
+	const auto addr = op.ra ? m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb)) : GetGpr(op.rb);
+	const auto masks = GetShiftMasks(addr);
+	const auto data = Call(GetType<u8[16]>(), m_pure_attr, "llvm.x86.ssse3.pshuf.b.128", GetVr(op.vs, VrType::vi8), masks.first);
+	Call(GetType<void>(), "llvm.x86.sse2.maskmov.dqu", data, masks.second, GetMemory(m_ir->CreateAnd(addr, -16), GetType<u8>()));
 }
 
 void PPUTranslator::STDBRX(ppu_opcode_t op)
@@ -3039,7 +3207,10 @@ void PPUTranslator::STFSX(ppu_opcode_t op)
 
 void PPUTranslator::STVRX(ppu_opcode_t op)
 {
-	Call(GetType<void>(), "__stvrx", op.ra ? m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb)) : GetGpr(op.rb), GetVr(op.vs, VrType::vi8));
+	const auto addr = op.ra ? m_ir->CreateAdd(GetGpr(op.ra), GetGpr(op.rb)) : GetGpr(op.rb);
+	const auto masks = GetShiftMasks(addr);
+	const auto data = Call(GetType<u8[16]>(), m_pure_attr, "llvm.x86.ssse3.pshuf.b.128", GetVr(op.vs, VrType::vi8), masks.second);
+	Call(GetType<void>(), "llvm.x86.sse2.maskmov.dqu", data, masks.first, GetMemory(m_ir->CreateAnd(addr, -16), GetType<u8>()));
 }
 
 void PPUTranslator::STFSUX(ppu_opcode_t op)
@@ -3186,13 +3357,13 @@ void PPUTranslator::DCBZ(ppu_opcode_t op)
 
 void PPUTranslator::LWZ(ppu_opcode_t op)
 {
-	SetGpr(op.rd, ReadMemory(op.ra ? m_ir->CreateAdd(GetGpr(op.ra), m_ir->getInt64(op.simm16)) : m_ir->getInt64(op.simm16), GetType<u32>()));
+	SetGpr(op.rd, ReadWord(op.ra ? m_ir->CreateAdd(GetGpr(op.ra), m_ir->getInt64(op.simm16)) : m_ir->getInt64(op.simm16), op.ra));
 }
 
 void PPUTranslator::LWZU(ppu_opcode_t op)
 {
 	const auto addr = m_ir->CreateAdd(GetGpr(op.ra), m_ir->getInt64(op.simm16));
-	SetGpr(op.rd, ReadMemory(addr, GetType<u32>()));
+	SetGpr(op.rd, ReadWord(addr, op.ra));
 	SetGpr(op.ra, addr);
 }
 
@@ -3210,13 +3381,13 @@ void PPUTranslator::LBZU(ppu_opcode_t op)
 
 void PPUTranslator::STW(ppu_opcode_t op)
 {
-	WriteMemory(op.ra ? m_ir->CreateAdd(GetGpr(op.ra), m_ir->getInt64(op.simm16)) : m_ir->getInt64(op.simm16), GetGpr(op.rs, 32));
+	WriteWord(op.ra ? m_ir->CreateAdd(GetGpr(op.ra), m_ir->getInt64(op.simm16)) : m_ir->getInt64(op.simm16), GetGpr(op.rs, 32), op.ra);
 }
 
 void PPUTranslator::STWU(ppu_opcode_t op)
 {
 	const auto addr = m_ir->CreateAdd(GetGpr(op.ra), m_ir->getInt64(op.simm16));
-	WriteMemory(addr, GetGpr(op.rs, 32));
+	WriteWord(addr, GetGpr(op.rs, 32), op.ra);
 	SetGpr(op.ra, addr);
 }
 
@@ -3932,17 +4103,7 @@ Value* PPUTranslator::GetGpr(u32 r, u32 num_bits)
 
 void PPUTranslator::SetGpr(u32 r, Value* value)
 {
-	const auto i64_val = m_ir->CreateZExt(value, GetType<u64>());
-
-	if (true) // Update local: all regs
-	{
-		m_ir->CreateStore(i64_val, m_gpr[r]);
-	}
-
-	if (r == 1) // Update global: SP
-	{
-		m_ir->CreateStore(i64_val, m_g_gpr[r]);
-	}
+	m_ir->CreateStore(m_ir->CreateZExt(value, GetType<u64>()), m_gpr[r]);
 }
 
 Value* PPUTranslator::GetFpr(u32 r, u32 bits, bool as_int)
@@ -161,11 +161,13 @@ class PPUTranslator final //: public CPUTranslator
 	// Thread context struct
 	llvm::StructType* m_thread_type;
 
+	// Registers exchanged via the context (args, results and r1/r2/r13), only accessed at call boundaries
 	llvm::Value* m_globals[96]{};
 	llvm::Value** const m_g_gpr = m_globals + 0;
 	llvm::Value** const m_g_fpr = m_globals + 32;
 	llvm::Value** const m_g_vr = m_globals + 64;
 
+	// Local copies of all registers (promoted to SSA)
 	llvm::Value* m_locals[96]{};
 	llvm::Value** const m_gpr = m_locals + 0;
 	llvm::Value** const m_fpr = m_locals + 32;
@@ -234,6 +236,12 @@ public:
 	// Set some registers to undef (after function call)
 	void UndefineVolatileRegisters();
 
+	// Write local copies of exchanged registers to the context (before function call or return)
+	void FlushRegisters();
+
+	// Read exchanged registers from the context (on entry or after function call)
+	void ReloadRegisters();
+
 	// Get the basic block for the specified address
 	llvm::BasicBlock* GetBasicBlock(u64 addr);
 
@@ -294,6 +302,9 @@ public:
 	// Multiply FP value or vector by the pow(2, scale)
 	llvm::Value* Scale(llvm::Value* value, s32 scale);
 
+	// Add values with carry flag (second result is the carry flag)
+	std::pair<llvm::Value*, llvm::Value*> AddWithCarry(llvm::Value* a, llvm::Value* b, llvm::Value* c);
+
 	// Create shuffle instruction with constant args
 	llvm::Value* Shuffle(llvm::Value* left, llvm::Value* right, std::initializer_list<u32> indices);
 
@@ -386,12 +397,27 @@ public:
 	// Get memory pointer
 	llvm::Value* GetMemory(llvm::Value* addr, llvm::Type* type);
 
+	// Get LVSL shift vector (host byte order)
+	llvm::Value* GetShiftVector(llvm::Value* addr);
+
+	// Get pshufb masks for LVLX/STVLX (first) and LVRX/STVRX (second)
+	std::pair<llvm::Value*, llvm::Value*> GetShiftMasks(llvm::Value* addr);
+
 	// Read from memory
 	llvm::Value* ReadMemory(llvm::Value* addr, llvm::Type* type, bool is_be = true, u32 align = 1);
 
 	// Write to memory
 	void WriteMemory(llvm::Value* addr, llvm::Value* value, bool is_be = true, u32 align = 1);
 
+	// Check whether the word access can hit RawSPU MMIO (ra: base register of D-form access, 0 if unknown)
+	bool MayAccessMmio(llvm::Value* addr, u32 ra);
+
+	// Read word from memory (RawSPU MMIO area is checked explicitly if necessary)
+	llvm::Value* ReadWord(llvm::Value* addr, u32 ra);
+
+	// Write word to memory (RawSPU MMIO area is checked explicitly if necessary)
+	void WriteWord(llvm::Value* addr, llvm::Value* value, u32 ra);
+
 	// Convert a C++ type to an LLVM type
 	template<typename T>
 	llvm::Type* GetType()
@@ -2,6 +2,7 @@
 #include "Emu/Memory/Memory.h"
 #include "Emu/System.h"
 #include "Emu/IdManager.h"
+#include "Emu/Benchmark.h"
 #include "Loader/ELF.h"
 
 #include "Emu/Cell/RawSPUThread.h"
@@ -177,6 +178,8 @@ bool RawSPUThread::write_reg(const u32 addr, const u32 value)
 	{
 		if (value == SPU_RUNCNTL_RUN_REQUEST)
 		{
+			// LS could be modified directly
+			invalidate_ls(0, 0x40000);
 			try_start();
 		}
 		else if (value == SPU_RUNCNTL_STOP_REQUEST)
@@ -236,3 +239,31 @@ void spu_load_exec(const spu_exec_object& elf)
 	spu->cpu_init();
 	spu->npc = elf.header.e_entry;
 }
+
+u32 raw_spu_mmio_read(u32 addr)
+{
+	if (UNLIKELY(g_perf_counters.enabled)) g_perf_counters.raw_spu_mmio++;
+
+	const auto thread = idm::get<RawSPUThread>((addr - RAW_SPU_BASE_ADDR) / RAW_SPU_OFFSET);
+
+	u32 value;
+
+	if (!thread || !thread->read_reg(addr, value))
+	{
+		fmt::throw_exception("Invalid RawSPU MMIO read (addr=0x%x)" HERE, addr);
+	}
+
+	return value;
+}
+
+void raw_spu_mmio_write(u32 addr, u32 value)
+{
+	if (UNLIKELY(g_perf_counters.enabled)) g_perf_counters.raw_spu_mmio++;
+
+	const auto thread = idm::get<RawSPUThread>((addr - RAW_SPU_BASE_ADDR) / RAW_SPU_OFFSET);
+
+	if (!thread || !thread->write_reg(addr, value))
+	{
+		fmt::throw_exception("Invalid RawSPU MMIO write (addr=0x%x, value=0x%x)" HERE, addr, value);
+	}
+}
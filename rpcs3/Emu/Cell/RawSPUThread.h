@@ -18,3 +18,13 @@ public:
 	bool read_reg(const u32 addr, u32& value);
 	bool write_reg(const u32 addr, const u32 value);
 };
+
+// Check whether the address belongs to RawSPU problem state area (never mapped, accessed through access violation otherwise)
+inline bool is_raw_spu_mmio(u32 addr)
+{
+	return addr - RAW_SPU_BASE_ADDR < 6 * RAW_SPU_OFFSET && addr % RAW_SPU_OFFSET >= RAW_SPU_PROB_OFFSET;
+}
+
+// Access RawSPU problem state register without access violation (throws on invalid access)
+u32 raw_spu_mmio_read(u32 addr);
+void raw_spu_mmio_write(u32 addr, u32 value);
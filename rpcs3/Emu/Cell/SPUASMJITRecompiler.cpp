@@ -1,6 +1,8 @@
 #include "stdafx.h"
+#include "Utilities/Config.h"
 #include "Emu/Memory/Memory.h"
 #include "Emu/System.h"
+#include "Emu/Benchmark.h"
 
 #include "SPUDisAsm.h"
 #include "SPUThread.h"
@@ -20,6 +22,11 @@
 #define SPU_OFF_16(x) asmjit::host::word_ptr(*cpu, (std::conditional_t<sizeof(SPUThread::x) == 2, u32, void>)OFFSET_32(SPUThread, x))
 #define SPU_OFF_8(x) asmjit::host::byte_ptr(*cpu, (std::conditional_t<sizeof(SPUThread::x) == 1, u32, void>)OFFSET_32(SPUThread, x))
 
+extern u64 get_system_time();
+
+cfg::bool_entry g_cfg_spu_jit_log(cfg::root.core, "SPU JIT log");
+cfg::set_entry g_cfg_spu_jit_log_filter(cfg::root.core, "SPU JIT log functions"); // Entry points (like 0x1230), all functions if empty
+
 const spu_decoder<spu_interpreter_fast> s_spu_interpreter; // TODO: remove
 const spu_decoder<spu_recompiler> s_spu_decoder;
 
@@ -31,7 +38,96 @@ spu_recompiler::spu_recompiler()
 
 	LOG_SUCCESS(SPU, "SPU Recompiler (ASMJIT) created...");
 
-	fs::file(fs::get_config_dir() + "SPUJIT.log", fs::rewrite).write(fmt::format("SPU JIT initialization...\n\nTitle: %s\nTitle ID: %s\n\n", Emu.GetTitle().c_str(), Emu.GetTitleID().c_str()));
+	if (!g_cfg_spu_jit_log)
+	{
+		return;
+	}
+
+	for (const auto& value : g_cfg_spu_jit_log_filter.get_set())
+	{
+		s64 addr;
+
+		if (cfg::try_to_int64(&addr, value, 0, 0x3fffc))
+		{
+			m_log_filter.emplace(static_cast<u32>(addr));
+		}
+	}
+
+	if (!m_log_file.open(fs::get_config_dir() + "SPUJIT.log", fs::rewrite))
+	{
+		LOG_ERROR(SPU, "Failed to open SPUJIT.log");
+		return;
+	}
+
+	m_log_enabled = true;
+	m_log_buffer = fmt::format("SPU JIT initialization...\n\nTitle: %s\nTitle ID: %s\n\n", Emu.GetTitle(), Emu.GetTitleID());
+
+	// Write the log asynchronously (flush every 100 ms or when the buffer is large)
+	thread_ctrl::spawn(m_log_thread, "SPU JIT Log", [this]()
+	{
+		std::string buffer;
+
+		while (true)
+		{
+			const bool stop = m_log_stop;
+
+			{
+				std::lock_guard<std::mutex> lock(m_log_mutex);
+				buffer.swap(m_log_buffer);
+			}
+
+			m_log_file.write(buffer);
+			buffer.clear();
+
+			if (stop)
+			{
+				break;
+			}
+
+			thread_lock{}, thread_ctrl::wait_for(100000, [&] { return m_log_stop || m_log_flush.exchange(false); });
+		}
+	});
+}
+
+spu_recompiler::~spu_recompiler()
+{
+	if (m_stat_funcs)
+	{
+		LOG_NOTICE(SPU, "SPU Recompiler: %llu functions compiled (guest code: %llu bytes, host code: %llu bytes, %.3f ms, %.3f ms per function)",
+			m_stat_funcs, m_stat_guest_size, m_stat_host_size, m_stat_time / 1000., m_stat_time / 1000. / m_stat_funcs);
+	}
+
+	if (m_log_thread)
+	{
+		m_log_stop = true;
+		m_log_thread->lock_notify();
+		m_log_thread->join();
+	}
+}
+
+void spu_recompiler::log_write(std::string&& text)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_log_mutex);
+
+		if (m_log_buffer.empty())
+		{
+			m_log_buffer = std::move(text);
+		}
+		else
+		{
+			m_log_buffer += text;
+		}
+
+		if (m_log_buffer.size() < 0x100000)
+		{
+			return;
+		}
+	}
+
+	// Wake up the log thread
+	m_log_flush = true;
+	m_log_thread->lock_notify();
 }
 
 void spu_recompiler::compile(spu_function_t& f)
@@ -51,19 +147,33 @@ void spu_recompiler::compile(spu_function_t& f)
 
 	using namespace asmjit;
 
+	const u64 stamp = get_system_time();
+
+	// Disassembly and ASMJIT logging are only done for logged functions
+	const bool log_func = m_log_enabled && (m_log_filter.empty() || m_log_filter.count(f.addr));
+
 	SPUDisAsm dis_asm(CPUDisAsm_InterpreterMode);
 	dis_asm.offset = reinterpret_cast<u8*>(f.data.data()) - f.addr;
 
 	StringLogger logger;
 	logger.setOption(kLoggerOptionBinaryForm, true);
 
-	std::string log = fmt::format("========== SPU FUNCTION 0x%05x - 0x%05x ==========\n\n", f.addr, f.addr + f.size);
+	std::string log;
+
+	if (log_func)
+	{
+		log = fmt::format("========== SPU FUNCTION 0x%05x - 0x%05x ==========\n\n", f.addr, f.addr + f.size);
+	}
 
 	this->m_func = &f;
 
 	X86Compiler compiler(m_jit.get());
 	this->c = &compiler;
-	compiler.setLogger(&logger);
+
+	if (log_func)
+	{
+		compiler.setLogger(&logger);
+	}
 
 	compiler.addFunc(kFuncConvHost, FuncBuilder2<u32, void*, void*>());
 
@@ -146,11 +256,14 @@ void spu_recompiler::compile(spu_function_t& f)
 		}
 
 		// Disasm
-		dis_asm.dump_pc = m_pos;
-		dis_asm.disasm(m_pos);
-		compiler.addComment(dis_asm.last_opcode.c_str());
-		log += dis_asm.last_opcode.c_str();
-		log += '\n';
+		if (log_func)
+		{
+			dis_asm.dump_pc = m_pos;
+			dis_asm.disasm(m_pos);
+			compiler.addComment(dis_asm.last_opcode.c_str());
+			log += dis_asm.last_opcode.c_str();
+			log += '\n';
+		}
 
 		// Recompiler function
 		(this->*s_spu_decoder.decode(op))({ op });
@@ -209,14 +322,31 @@ void spu_recompiler::compile(spu_function_t& f)
 	compiler.endFunc();
 
 	// Compile and store function address
+	const std::size_t used = m_jit->getMemMgr()->getUsedBytes();
+
 	f.compiled = asmjit_cast<decltype(f.compiled)>(compiler.make());
 
-	// Add ASMJIT logs
-	log += logger.getString();
-	log += "\n\n\n";
+	const std::size_t host_size = m_jit->getMemMgr()->getUsedBytes() - used;
+
+	// Update statistics
+	const u64 time = get_system_time() - stamp;
+	m_stat_funcs++;
+	m_stat_guest_size += f.size;
+	m_stat_host_size += host_size;
+	m_stat_time += time;
+	g_perf_counters.spu_compiled++;
+	g_perf_counters.spu_compile_time += time;
+	g_perf_counters.spu_guest_size += f.size;
+	g_perf_counters.spu_host_size += host_size;
+
+	if (log_func)
+	{
+		// Add ASMJIT logs
+		log += logger.getString();
+		fmt::append(log, "\nHost code: %u bytes\n\n\n", host_size);
 
-	// Append log file
-	fs::file(fs::get_config_dir() + "SPUJIT.log", fs::write + fs::append).write(log);
+		log_write(std::move(log));
+	}
 }
 
 spu_recompiler::XmmLink spu_recompiler::XmmAlloc() // get empty xmm register
@@ -340,6 +470,7 @@ void spu_recompiler::FunctionCall()
 				LOG_ERROR(SPU, "Branch-to-self");
 			}
 
+			// SPUThread::check_state() also gives up the execution slot on cpu_flag::yield
 			while (!test(_spu->state) || !_spu->check_state())
 			{
 				// Proceed recursively
@@ -392,7 +523,8 @@ void spu_recompiler::LNOP(spu_opcode_t op)
 void spu_recompiler::SYNC(spu_opcode_t op)
 {
 	// This instruction must be used following a store instruction that modifies the instruction stream.
-	c->mfence();
+	// Stores aren't tracked by the recompiler, the interpreter invalidates the function cache.
+	InterpreterCall(op);
 }
 
 void spu_recompiler::DSYNC(spu_opcode_t op)
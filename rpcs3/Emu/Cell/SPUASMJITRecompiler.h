@@ -1,6 +1,10 @@
 #pragma once
 
 #include "SPURecompiler.h"
+#include "Utilities/Thread.h"
+#include "Utilities/File.h"
+
+#include <set>
 
 namespace asmjit
 {
@@ -17,8 +21,27 @@ class spu_recompiler : public spu_recompiler_base
 {
 	const std::shared_ptr<asmjit::JitRuntime> m_jit;
 
+	// JIT log (disabled by default)
+	bool m_log_enabled = false;
+	std::set<u32> m_log_filter; // Function addresses to log (all if empty)
+	fs::file m_log_file;
+	std::mutex m_log_mutex;
+	std::string m_log_buffer; // Written by the compiler thread, drained by the log thread
+	atomic_t<bool> m_log_stop{false};
+	atomic_t<bool> m_log_flush{false}; // Set when the buffer is large
+	std::shared_ptr<thread_ctrl> m_log_thread;
+
+	// Compilation statistics
+	u64 m_stat_funcs = 0;
+	u64 m_stat_guest_size = 0;
+	u64 m_stat_host_size = 0;
+	u64 m_stat_time = 0; // us
+
+	void log_write(std::string&& text);
+
 public:
 	spu_recompiler();
+	~spu_recompiler();
 
 	virtual void compile(spu_function_t& f) override;
 
@@ -320,3 +320,20 @@ std::shared_ptr<spu_function_t> SPUDatabase::analyse(const be_t<u32>* ls, u32 en
 
 	return func;
 }
+
+std::shared_ptr<spu_function_t> SPUDatabase::find_function(u32 addr)
+{
+	reader_lock lock(m_mutex);
+
+	for (const auto& pair : m_db)
+	{
+		const auto& func = pair.second;
+
+		if (addr >= func->addr && addr < func->addr + func->size)
+		{
+			return func;
+		}
+	}
+
+	return nullptr;
+}
@@ -3,6 +3,8 @@
 #include "Utilities/mutex.h"
 
 #include <set>
+#include <array>
+#include <atomic>
 
 // SPU Instruction Type
 struct spu_itype
@@ -297,4 +299,95 @@ public:
 
 	// Try to retrieve SPU function information
 	std::shared_ptr<spu_function_t> analyse(const be_t<u32>* ls, u32 entry, u32 limit = 0x40000);
+
+	// Find any registered function containing the specified LS address (for diagnostic purposes)
+	std::shared_ptr<spu_function_t> find_function(u32 addr);
+};
+
+// Functions by entry point for a single SPU thread (avoids the database lookup and validation on every call)
+class spu_function_cache
+{
+	// Function for every instruction slot (nullptr if not cached)
+	std::array<spu_function_t*, 0x10000> m_funcs{};
+
+	// Lines containing the code of cached functions (1 bit per 128 bytes)
+	std::array<atomic_t<u64>, 0x40000 / 128 / 64> m_code;
+
+	// Set when a line containing cached code is modified
+	atomic_t<bool> m_flush{false};
+
+public:
+	spu_function_cache()
+	{
+		for (auto& bits : m_code)
+		{
+			bits.store(0);
+		}
+	}
+
+	// Mark LS range as modified (can be called from any thread, after the modification)
+	void invalidate(u32 lsa, u32 size)
+	{
+		if (size == 0)
+		{
+			return;
+		}
+
+		// Order the modification before reading the bits (see add())
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		for (u32 i = (lsa & 0x3ffff) / 128, end = std::min<u32>(lsa + size - 1, 0x3ffff) / 128; i <= end; i++)
+		{
+			if (UNLIKELY(m_code[i / 64].load() & (1ull << (i % 64))))
+			{
+				m_flush = true;
+				return;
+			}
+		}
+	}
+
+	// Invalidate all functions (instruction stream synchronization)
+	void invalidate_all()
+	{
+		m_flush = true;
+	}
+
+	// Get cached function (owner thread only)
+	spu_function_t* find(u32 pc)
+	{
+		if (UNLIKELY(m_flush.load()))
+		{
+			m_flush = false;
+			m_funcs.fill(nullptr);
+
+			for (auto& bits : m_code)
+			{
+				bits.store(0);
+			}
+		}
+
+		return m_funcs[pc / 4];
+	}
+
+	// Cache the function found in the database (owner thread only), the code is checked again after its lines are marked
+	void add(spu_function_t& func, const be_t<u32>* ls)
+	{
+		for (u32 i = func.addr / 128, end = (func.addr + func.size - 1) / 128; i <= end; i++)
+		{
+			const u64 bit = 1ull << (i % 64);
+
+			if (!(m_code[i / 64].load() & bit))
+			{
+				m_code[i / 64].fetch_or(bit);
+			}
+		}
+
+		// Locked operation above orders the check after marking, so concurrent modifications are either detected here or flush the cache
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (std::memcmp(func.data.data(), ls + func.addr / 4, func.size) == 0)
+		{
+			m_funcs[func.addr / 4] = &func;
+		}
+	}
 };
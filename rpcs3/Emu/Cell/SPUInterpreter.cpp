@@ -67,7 +67,19 @@ void spu_interpreter::LNOP(SPUThread& spu, spu_opcode_t op)
 // This instruction must be used following a store instruction that modifies the instruction stream.
 void spu_interpreter::SYNC(SPUThread& spu, spu_opcode_t op)
 {
-	_mm_mfence(); 
+	_mm_mfence();
+
+	// Instruction stream synchronization: refresh predecoded instructions
+	if (spu.inter_cache)
+	{
+		spu.inter_cache->line = -1;
+	}
+
+	// Compiled functions may have been modified by SPU stores
+	if (spu.func_cache)
+	{
+		spu.func_cache->invalidate_all();
+	}
 }
 
 // This instruction forces all earlier load, store, and channel instructions to complete before proceeding.
@@ -352,7 +364,9 @@ void spu_interpreter::STOPD(SPUThread& spu, spu_opcode_t op)
 
 void spu_interpreter::STQX(SPUThread& spu, spu_opcode_t op)
 {
-	spu._ref<v128>((spu.gpr[op.ra]._u32[3] + spu.gpr[op.rb]._u32[3]) & 0x3fff0) = spu.gpr[op.rt];
+	const u32 lsa = (spu.gpr[op.ra]._u32[3] + spu.gpr[op.rb]._u32[3]) & 0x3fff0;
+	spu._ref<v128>(lsa) = spu.gpr[op.rt];
+	spu.invalidate_ls(lsa, 16);
 }
 
 void spu_interpreter::BI(SPUThread& spu, spu_opcode_t op)
@@ -994,6 +1008,7 @@ void spu_interpreter::BRZ(SPUThread& spu, spu_opcode_t op)
 void spu_interpreter::STQA(SPUThread& spu, spu_opcode_t op)
 {
 	spu._ref<v128>(spu_ls_target(0, op.i16)) = spu.gpr[op.rt];
+	spu.invalidate_ls(spu_ls_target(0, op.i16), 16);
 }
 
 void spu_interpreter::BRNZ(SPUThread& spu, spu_opcode_t op)
@@ -1023,6 +1038,7 @@ void spu_interpreter::BRHNZ(SPUThread& spu, spu_opcode_t op)
 void spu_interpreter::STQR(SPUThread& spu, spu_opcode_t op)
 {
 	spu._ref<v128>(spu_ls_target(spu.pc, op.i16)) = spu.gpr[op.rt];
+	spu.invalidate_ls(spu_ls_target(spu.pc, op.i16), 16);
 }
 
 void spu_interpreter::BRA(SPUThread& spu, spu_opcode_t op)
@@ -1137,7 +1153,9 @@ void spu_interpreter::AHI(SPUThread& spu, spu_opcode_t op)
 
 void spu_interpreter::STQD(SPUThread& spu, spu_opcode_t op)
 {
-	spu._ref<v128>((spu.gpr[op.ra]._s32[3] + (op.si10 << 4)) & 0x3fff0) = spu.gpr[op.rt];
+	const u32 lsa = (spu.gpr[op.ra]._s32[3] + (op.si10 << 4)) & 0x3fff0;
+	spu._ref<v128>(lsa) = spu.gpr[op.rt];
+	spu.invalidate_ls(lsa, 16);
 }
 
 void spu_interpreter::LQD(SPUThread& spu, spu_opcode_t op)
@@ -247,3 +247,71 @@ struct spu_interpreter_precise final : spu_interpreter
 	static void FMA(SPUThread&, spu_opcode_t);
 	static void FMS(SPUThread&, spu_opcode_t);
 };
+
+// Predecoded interpreter handlers for the whole LS, revalidated lazily per 128-byte line
+class spu_interpreter_cache
+{
+	// Interpreter function for every instruction slot
+	std::array<spu_inter_func_t, 0x10000> m_func;
+
+	// Lines which must be decoded again before execution (1 bit per 128 bytes)
+	std::array<atomic_t<u64>, 0x40000 / 128 / 64> m_dirty;
+
+public:
+	// Line being executed (only accessed by the owner thread, -1 forces revalidation)
+	u32 line = -1;
+
+	spu_interpreter_cache()
+	{
+		for (auto& bits : m_dirty)
+		{
+			bits.store(-1);
+		}
+	}
+
+	// Mark LS range as modified (can be called from any thread)
+	void invalidate(u32 lsa, u32 size)
+	{
+		if (size == 0)
+		{
+			return;
+		}
+
+		for (u32 i = (lsa & 0x3ffff) / 128, end = std::min<u32>(lsa + size - 1, 0x3ffff) / 128; i <= end; i++)
+		{
+			auto& bits = m_dirty[i / 64];
+			const u64 bit = 1ull << (i % 64);
+
+			// Avoid locked operation if the line is already dirty (data is usually written repeatedly)
+			if (!(bits.load() & bit))
+			{
+				bits.fetch_or(bit);
+			}
+		}
+	}
+
+	// Decode the line containing pc if it was modified, set it as current
+	void validate(u32 pc, const be_t<u32>* ls, const std::array<spu_inter_func_t, 2048>& table)
+	{
+		line = pc / 128;
+
+		auto& bits = m_dirty[line / 64];
+		const u64 bit = 1ull << (line % 64);
+
+		if (UNLIKELY(bits.load() & bit))
+		{
+			// Reset the bit first, so concurrent modifications aren't lost
+			bits.fetch_and(~bit);
+
+			for (u32 i = line * 32, end = i + 32; i < end; i++)
+			{
+				m_func[i] = table[spu_decode(ls[i])];
+			}
+		}
+	}
+
+	spu_inter_func_t operator[](u32 pc) const
+	{
+		return m_func[pc / 4];
+	}
+};
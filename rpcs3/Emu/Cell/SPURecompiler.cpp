@@ -22,8 +22,18 @@ void spu_recompiler_base::enter(SPUThread& spu)
 	// Get SPU LS pointer
 	const auto _ls = vm::ps3::_ptr<u32>(spu.offset);
 
-	// Always validate (TODO)
-	const auto func = spu.spu_db->analyse(_ls, spu.pc);
+	// Find function compiled from the current LS contents (validated only when it's not cached)
+	spu_function_t* func = spu.func_cache ? spu.func_cache->find(spu.pc) : nullptr;
+
+	if (UNLIKELY(!func))
+	{
+		func = spu.spu_db->analyse(_ls, spu.pc).get();
+
+		if (spu.func_cache)
+		{
+			spu.func_cache->add(*func, _ls);
+		}
+	}
 
 	// Reset callstack if necessary
 	if (func->does_reset_stack && spu.recursion_level)
@@ -44,6 +54,8 @@ void spu_recompiler_base::enter(SPUThread& spu)
 		if (!func->compiled) fmt::throw_exception("Compilation failed" HERE);
 	}
 
+	spu.block_counter++;
+
 	const u32 res = func->compiled(&spu, _ls);
 
 	if (const auto exception = spu.pending_exception)
@@ -0,0 +1,214 @@
+#include "stdafx.h"
+#include "Utilities/Config.h"
+#include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
+#include "Emu/IdManager.h"
+#include "SPUThread.h"
+#include "SPUScheduler.h"
+
+#include <thread>
+#include <algorithm>
+
+extern u64 get_system_time();
+
+cfg::int_entry<0, 6> g_cfg_spu_running_threads(cfg::root.core, "SPU Running Threads Limit", 0); // 0: unlimited
+cfg::int_entry<0, 16> g_cfg_spu_reserved_cores(cfg::root.core, "Host Cores Reserved for PPU/RSX", 0); // Not used by SPU threads
+
+// Time slice for threads which don't block (us)
+static const u64 s_spu_time_slice = 2000;
+
+spu_scheduler::spu_scheduler(u32 max)
+	: m_max(max)
+{
+	LOG_NOTICE(SPU, "SPU scheduler: %u threads", m_max);
+}
+
+spu_scheduler::~spu_scheduler()
+{
+	LOG_NOTICE(SPU, "SPU scheduler: %llu switches, %llu preemptions", m_switches, m_preemptions);
+}
+
+void spu_scheduler::preempt()
+{
+	const u64 now = get_system_time();
+
+	SPUThread* target = nullptr;
+
+	for (SPUThread* spu : m_running)
+	{
+		if (!target || spu->sched_stamp < target->sched_stamp)
+		{
+			target = spu;
+		}
+	}
+
+	if (target && now - target->sched_stamp >= s_spu_time_slice)
+	{
+		if (!target->state.test_and_set(cpu_flag::yield))
+		{
+			m_preemptions++;
+		}
+	}
+}
+
+void spu_scheduler::acquire(SPUThread& spu)
+{
+	if (spu.sched_running)
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	const u64 start = get_system_time();
+
+	m_ready.push_back(&spu);
+
+	while (m_running.size() >= m_max || m_ready.front() != &spu)
+	{
+		if (Emu.IsStopped() || test(spu.state & cpu_flag::stop + cpu_flag::exit))
+		{
+			m_ready.erase(std::find(m_ready.begin(), m_ready.end(), &spu));
+			m_cv.notify_all();
+			return;
+		}
+
+		if (m_ready.front() == &spu && get_system_time() - start >= s_spu_time_slice)
+		{
+			preempt();
+		}
+
+		m_cv.wait_for(lock, std::chrono::milliseconds(1));
+	}
+
+	m_ready.erase(m_ready.begin());
+	m_running.push_back(&spu);
+	m_switches++;
+
+	spu.sched_running = true;
+	spu.sched_stamp = get_system_time();
+
+	if (m_ready.size() && m_running.size() < m_max)
+	{
+		m_cv.notify_all();
+	}
+}
+
+void spu_scheduler::release(SPUThread& spu)
+{
+	if (!spu.sched_running)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_running.erase(std::find(m_running.begin(), m_running.end(), &spu));
+
+	spu.sched_running = false;
+	spu.state -= cpu_flag::yield;
+
+	if (m_ready.size())
+	{
+		m_cv.notify_all();
+	}
+}
+
+void spu_scheduler::yield(SPUThread& spu)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		spu.state -= cpu_flag::yield;
+
+		if (m_ready.empty())
+		{
+			return;
+		}
+	}
+
+	release(spu);
+	acquire(spu);
+}
+
+std::shared_ptr<spu_scheduler> spu_scheduler::get()
+{
+	if (const u32 max = g_cfg_spu_running_threads)
+	{
+		return fxm::get_always<spu_scheduler>(max);
+	}
+
+	return nullptr;
+}
+
+void spu_scheduler::set_affinity()
+{
+	thread_local bool s_placed = false;
+
+	if (s_placed)
+	{
+		return;
+	}
+
+	s_placed = true;
+
+	const u32 reserved = g_cfg_spu_reserved_cores;
+	const u32 count = std::thread::hardware_concurrency();
+
+	if (reserved == 0 || reserved >= count || count > 64)
+	{
+		return;
+	}
+
+	// Use the cores after the reserved ones
+	const u64 all = count == 64 ? ~0ull : (1ull << count) - 1;
+	thread_ctrl::set_native_affinity(all & ~((1ull << reserved) - 1));
+}
+
+spu_scheduler_task::spu_scheduler_task(SPUThread& spu)
+	: m_spu(spu)
+{
+	spu_scheduler::set_affinity();
+
+	if (!g_cfg_spu_running_threads)
+	{
+		return;
+	}
+
+	if (!spu.spu_sched)
+	{
+		spu.spu_sched = spu_scheduler::get();
+	}
+
+	if (test(spu.state, cpu_flag::yield))
+	{
+		spu.spu_sched->yield(spu);
+	}
+
+	spu.spu_sched->acquire(spu);
+}
+
+spu_scheduler_task::~spu_scheduler_task()
+{
+	if (m_spu.spu_sched && (test(m_spu.state & cpu_flag::stop + cpu_flag::exit) || std::uncaught_exception()))
+	{
+		m_spu.spu_sched->release(m_spu);
+	}
+}
+
+void spu_scheduler_wait::release()
+{
+	if (m_spu.spu_sched && m_spu.sched_running)
+	{
+		m_sched = m_spu.spu_sched;
+		m_sched->release(m_spu);
+	}
+}
+
+spu_scheduler_wait::~spu_scheduler_wait()
+{
+	if (m_sched)
+	{
+		m_sched->acquire(m_spu);
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Utilities/types.h"
+
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+class SPUThread;
+
+// Limits the amount of SPU threads executing simultaneously (optional, must be PS3 process-local).
+// Threads give up the slot in blocking channel operations, stop-and-signal and while suspended or paused, the slot is given in FIFO order.
+// Threads polling without blocking are asked to yield (cpu_flag::yield) after the time slice.
+class spu_scheduler
+{
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+
+	const u32 m_max; // Max threads executing
+
+	std::vector<SPUThread*> m_running;
+	std::vector<SPUThread*> m_ready; // Threads waiting for the slot (FIFO)
+
+	u64 m_switches = 0;
+	u64 m_preemptions = 0;
+
+	// Ask the thread running the longest to yield
+	void preempt();
+
+public:
+	spu_scheduler(u32 max);
+	~spu_scheduler();
+
+	// Get execution slot (waits, returns without the slot if the thread or the emulation is stopping)
+	void acquire(SPUThread& spu);
+
+	// Release execution slot
+	void release(SPUThread& spu);
+
+	// Give up the slot if there are waiting threads
+	void yield(SPUThread& spu);
+
+	// Get the scheduler if enabled (nullptr otherwise)
+	static std::shared_ptr<spu_scheduler> get();
+
+	// Place the current host thread on the SPU cores (once per host thread)
+	static void set_affinity();
+};
+
+// Task scope: get the execution slot (handles yield requests), release it if the thread is stopped at the end of the scope
+class spu_scheduler_task
+{
+	SPUThread& m_spu;
+
+public:
+	spu_scheduler_task(SPUThread& spu);
+	~spu_scheduler_task();
+
+	spu_scheduler_task(const spu_scheduler_task&) = delete;
+};
+
+// Blocking scope: the slot is released by release() (before waiting) and acquired again at the end of the scope
+class spu_scheduler_wait
+{
+	SPUThread& m_spu;
+	std::shared_ptr<spu_scheduler> m_sched;
+
+public:
+	spu_scheduler_wait(SPUThread& spu)
+		: m_spu(spu)
+	{
+	}
+
+	void release();
+
+	~spu_scheduler_wait();
+
+	spu_scheduler_wait(const spu_scheduler_wait&) = delete;
+};
@@ -15,6 +15,7 @@
 #include "Emu/Cell/SPUThread.h"
 #include "Emu/Cell/SPUInterpreter.h"
 #include "Emu/Cell/SPURecompiler.h"
+#include "Emu/Cell/SPUScheduler.h"
 
 #include "Emu/Memory/wait_engine.h"
 
@@ -175,14 +176,45 @@ void SPUThread::cpu_init()
 	int_ctrl[2].clear();
 
 	gpr[1]._u32[3] = 0x3FFF0; // initial stack frame pointer
+
+	invalidate_ls(0, 0x40000);
 }
 
 extern thread_local std::string(*g_tls_log_prefix)();
 
+bool SPUThread::check_state()
+{
+	// Called from the interpreter loop and from recompiled code (including nested function calls)
+	if (UNLIKELY(test(state, cpu_flag::yield)))
+	{
+		if (spu_sched)
+		{
+			spu_sched->yield(*this);
+		}
+		else
+		{
+			state -= cpu_flag::yield;
+		}
+	}
+
+	// Don't hold the execution slot while suspended or paused (taken back at the end of the scope)
+	spu_scheduler_wait sched_wait(*this);
+
+	if (test(state, cpu_state_pause))
+	{
+		sched_wait.release();
+	}
+
+	return cpu_thread::check_state();
+}
+
 void SPUThread::cpu_task()
 {
 	std::fesetround(FE_TOWARDZERO);
 
+	// Host placement and execution slot
+	spu_scheduler_task sched_task(*this);
+
 	if (custom_task)
 	{
 		if (check_state()) return;
@@ -212,15 +244,21 @@ void SPUThread::cpu_task()
 	// LS base address
 	const auto base = vm::_ptr<const u32>(offset);
 
+	// Predecoded instructions
+	auto& cache = *inter_cache;
+
 	while (true)
 	{
 		if (!test(state))
 		{
-			// Read opcode
-			const u32 op = base[pc / 4];
+			// Decode modified instructions when entering another line
+			if (UNLIKELY(pc / 128 != cache.line))
+			{
+				cache.validate(pc, base, table);
+			}
 
 			// Call interpreter function
-			table[spu_decode(op)](*this, { op });
+			cache[pc](*this, { base[pc / 4] });
 
 			// Next instruction
 			pc += 4;
@@ -228,9 +266,34 @@ void SPUThread::cpu_task()
 		}
 
 		if (check_state()) return;
+
+		// Pick up modifications made while the thread was stopped or paused
+		cache.line = -1;
 	}
 }
 
+// Allocate predecoded LS only if the interpreter is used
+static std::unique_ptr<spu_interpreter_cache> make_inter_cache()
+{
+	if (g_cfg_spu_decoder.get() == spu_decoder_type::precise || g_cfg_spu_decoder.get() == spu_decoder_type::fast)
+	{
+		return std::make_unique<spu_interpreter_cache>();
+	}
+
+	return nullptr;
+}
+
+// Allocate function cache only if the recompiler is used
+static std::unique_ptr<spu_function_cache> make_func_cache()
+{
+	if (g_cfg_spu_decoder.get() == spu_decoder_type::asmjit)
+	{
+		return std::make_unique<spu_function_cache>();
+	}
+
+	return nullptr;
+}
+
 SPUThread::~SPUThread()
 {
 	// Deallocate Local Storage
@@ -242,6 +305,8 @@ SPUThread::SPUThread(const std::string& name)
 	, m_name(name)
 	, index(0)
 	, offset(0)
+	, inter_cache(make_inter_cache())
+	, func_cache(make_func_cache())
 {
 }
 
@@ -250,6 +315,8 @@ SPUThread::SPUThread(const std::string& name, u32 index)
 	, m_name(name)
 	, index(index)
 	, offset(verify("SPU LS" HERE, vm::alloc(0x40000, vm::main)))
+	, inter_cache(make_inter_cache())
+	, func_cache(make_func_cache())
 {
 }
 
@@ -292,6 +359,11 @@ void SPUThread::do_dma_transfer(u32 cmd, spu_mfc_arg_t args)
 			if (offset + args.size - 1 < 0x40000) // LS access
 			{
 				eal = spu.offset + offset; // redirect access
+
+				if (cmd & MFC_PUT_CMD)
+				{
+					spu.invalidate_ls(offset, args.size);
+				}
 			}
 			else if ((cmd & MFC_PUT_CMD) && args.size == 4 && (offset == SYS_SPU_THREAD_SNR1 || offset == SYS_SPU_THREAD_SNR2))
 			{
@@ -321,6 +393,7 @@ void SPUThread::do_dma_transfer(u32 cmd, spu_mfc_arg_t args)
 	case MFC_GET_CMD:
 	{
 		std::memcpy(vm::base(offset + args.lsa), vm::base(eal), args.size);
+		invalidate_ls(args.lsa, args.size);
 		return;
 	}
 	}
@@ -424,6 +497,7 @@ void SPUThread::process_mfc_cmd(u32 cmd)
 		const u32 raddr = vm::cast(ch_mfc_args.ea, HERE);
 
 		vm::reservation_acquire(vm::base(offset + ch_mfc_args.lsa), raddr, 128);
+		invalidate_ls(ch_mfc_args.lsa, 128);
 
 		if (std::exchange(last_raddr, raddr))
 		{
@@ -595,10 +669,14 @@ bool SPUThread::get_ch_value(u32 ch, u32& out)
 {
 	LOG_TRACE(SPU, "get_ch_value(ch=%d [%s])", ch, ch < 128 ? spu_ch_name[ch] : "???");
 
+	// Execution slot is given up while waiting
+	spu_scheduler_wait sched_wait(*this);
+
 	auto read_channel = [&](spu_channel_t& channel)
 	{
 		if (!channel.try_pop(out))
 		{
+			sched_wait.release();
 			thread_lock{*this}, thread_ctrl::wait([&] { return test(state & cpu_flag::stop) || channel.try_pop(out); });
 
 			return !test(state & cpu_flag::stop);
@@ -637,6 +715,7 @@ bool SPUThread::get_ch_value(u32 ch, u32& out)
 
 			if (!lock)
 			{
+				sched_wait.release();
 				lock.lock();
 				continue;
 			}
@@ -699,6 +778,8 @@ bool SPUThread::get_ch_value(u32 ch, u32& out)
 			return true;
 		}
 
+		sched_wait.release();
+
 		if (ch_event_mask & SPU_EVENT_LR)
 		{
 			// register waiter if polling reservation status is required
@@ -744,6 +825,9 @@ bool SPUThread::set_ch_value(u32 ch, u32 value)
 {
 	LOG_TRACE(SPU, "set_ch_value(ch=%d [%s], value=0x%x)", ch, ch < 128 ? spu_ch_name[ch] : "???", value);
 
+	// Execution slot is given up while waiting
+	spu_scheduler_wait sched_wait(*this);
+
 	switch (ch)
 	{
 	//case SPU_WrSRR0:
@@ -766,6 +850,7 @@ bool SPUThread::set_ch_value(u32 ch, u32 value)
 
 				if (!lock)
 				{
+					sched_wait.release();
 					lock.lock();
 					continue;
 				}
@@ -973,6 +1058,7 @@ bool SPUThread::set_ch_value(u32 ch, u32 value)
 
 			if (!lock)
 			{
+				sched_wait.release();
 				lock.lock();
 				continue;
 			}
@@ -1126,6 +1212,10 @@ bool SPUThread::stop_and_signal(u32 code)
 {
 	LOG_TRACE(SPU, "stop_and_signal(code=0x%x)", code);
 
+	// Execution slot is given up (may wait)
+	spu_scheduler_wait sched_wait(*this);
+	sched_wait.release();
+
 	if (offset >= RAW_SPU_BASE_ADDR)
 	{
 		status.atomic_op([code](u32& status)
@@ -1449,6 +1539,7 @@ void SPUThread::RegisterHleFunction(u32 addr, std::function<bool(SPUThread&)> fu
 {
 	m_addr_to_hle_function_map[addr] = function;
 	_ref<u32>(addr) = 0x00000003; // STOP 3
+	invalidate_ls(addr, 4);
 }
 
 void SPUThread::UnregisterHleFunction(u32 addr)
@@ -3,6 +3,7 @@
 #include "Emu/Cell/Common.h"
 #include "Emu/CPU/CPUThread.h"
 #include "Emu/Cell/SPUInterpreter.h"
+#include "Emu/Cell/SPUAnalyser.h"
 #include "MFC.h"
 
 class lv2_event_queue_t;
@@ -497,6 +498,9 @@ public:
 	virtual ~SPUThread() override;
 	void cpu_init();
 
+	// Handle cpu_flag::yield (see spu_scheduler) and process thread state, return true if the checker must return
+	bool check_state();
+
 protected:
 	SPUThread(const std::string& name);
 
@@ -560,7 +564,16 @@ public:
 
 	std::shared_ptr<class SPUDatabase> spu_db;
 	std::shared_ptr<class spu_recompiler_base> spu_rec;
+	std::shared_ptr<class spu_scheduler> spu_sched;
+
+	// SPU scheduler state (see spu_scheduler)
+	bool sched_running = false; // Holds the execution slot
+	u64 sched_stamp = 0; // Time the slot was acquired
 	u32 recursion_level = 0;
+	u64 block_counter = 0; // Compiled functions entered (statistics)
+
+	std::unique_ptr<spu_interpreter_cache> inter_cache; // Predecoded LS (interpreters only)
+	std::unique_ptr<spu_function_cache> func_cache; // Compiled functions by entry point (recompiler only)
 
 	void push_snr(u32 number, u32 value);
 	void do_dma_transfer(u32 cmd, spu_mfc_arg_t args);
@@ -578,6 +591,20 @@ public:
 
 	void fast_call(u32 ls_addr);
 
+	// Notify that LS range was modified (predecoded instructions must be refreshed)
+	void invalidate_ls(u32 lsa, u32 size)
+	{
+		if (inter_cache)
+		{
+			inter_cache->invalidate(lsa, size);
+		}
+
+		if (func_cache)
+		{
+			func_cache->invalidate(lsa, size);
+		}
+	}
+
 	// Convert specified SPU LS address to a pointer of specified (possibly converted to BE) type
 	template<typename T>
 	inline to_be_t<T>* _ptr(u32 lsa)
@@ -2,8 +2,10 @@
 #include "Utilities/Config.h"
 #include "Utilities/AutoPause.h"
 #include "Emu/System.h"
+#include "Emu/Benchmark.h"
 
 #include "Emu/Cell/PPUFunction.h"
+#include "Emu/Cell/PPUScheduler.h"
 #include "Emu/Cell/ErrorCodes.h"
 #include "sys_sync.h"
 #include "sys_lwmutex.h"
@@ -986,6 +988,11 @@ extern void ppu_execute_syscall(ppu_thread& ppu, u64 code)
 		// If autopause occures, check_status() will hold the thread till unpaused.
 		if (debug::autopause::pause_syscall(code) && ppu.check_state()) throw cpu_flag::ret;
 
+		if (UNLIKELY(g_perf_counters.enabled)) g_perf_counters.ppu_syscalls++;
+
+		// Give up the execution slot while in the kernel
+		ppu_scheduler_scope sched_scope(ppu, false);
+
 		if (auto func = g_ppu_syscall_table[code])
 		{
 			func(ppu);
@@ -636,6 +636,8 @@ s32 sys_spu_thread_write_ls(u32 id, u32 lsa, u64 value, u32 type)
 	default: return CELL_EINVAL;
 	}
 
+	thread->invalidate_ls(lsa, type);
+
 	return CELL_OK;
 }
 
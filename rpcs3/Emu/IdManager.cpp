@@ -25,54 +25,24 @@ u32 id_manager::typeinfo::add_type()
 
 id_manager::id_map::pointer idm::allocate_id(std::pair<u32, u32> types, u32 base, u32 step, u32 count)
 {
-	auto& map = g_map[types.first];
-
-	// Assume next ID
-	u32 next = base;
-	
-	if (std::size_t _count = map.size())
-	{
-		if (_count >= count)
-		{
-			return nullptr;
-		}
-
-		const u32 _next = map.rbegin()->first.id() + step;
-
-		if (_next > base && _next < base + step * count)
-		{
-			next = _next;
-		}
-	}
-
-	// Check all IDs starting from "next id" (TODO)
-	for (next; next < base + step * count; next += step)
+	if (const auto place = g_map[types.first].allocate(types.second, base, step, count))
 	{
-		// Get ID
-		const auto result = map.emplace(id_manager::id_key(next, types.second), nullptr);
+		// Acknowledge the ID
+		g_id = place->id;
 
-		if (result.second)
-		{
-			// Acknowledge the ID
-			g_id = next;
-
-			return std::addressof(*result.first);
-		}
+		return place;
 	}
 
-	// Nothing found
 	return nullptr;
 }
 
 id_manager::id_map::pointer idm::find_id(u32 type, u32 true_type, u32 id)
 {
-	auto& map = g_map[type];
-
-	const auto found = map.find(id);
+	const auto found = g_map[type].find(id);
 
-	if (found != map.end() && (type == true_type || found->first.type() == true_type))
+	if (found && (type == true_type || found->type() == true_type))
 	{
-		return std::addressof(*found);
+		return found;
 	}
 
 	return nullptr;
@@ -86,10 +56,9 @@ std::shared_ptr<void> idm::delete_id(u32 type, u32 true_type, u32 id)
 
 	std::shared_ptr<void> result;
 
-	if (found != map.end() && (type == true_type || found->first.type() == true_type))
+	if (found && (type == true_type || found->type() == true_type))
 	{
-		result = std::move(found->second);
-		map.erase(found);
+		result = map.erase(found);
 	}
 
 	return result;
@@ -107,10 +76,10 @@ void idm::clear()
 	{
 		const auto on_stop = id_manager::typeinfo::get()[i].on_stop;
 
-		for (auto& id : g_map[i])
+		g_map[i].for_each([&](id_manager::id_key, std::shared_ptr<void>& ptr)
 		{
-			on_stop(id.second.get());
-		}
+			on_stop(ptr.get());
+		});
 
 		g_map[i].clear();
 	}
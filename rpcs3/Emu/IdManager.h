@@ -5,7 +5,6 @@
 
 #include <memory>
 #include <vector>
-#include <map>
 
 // idm/fxm: helper namespace
 namespace id_manager
@@ -34,6 +33,7 @@ namespace id_manager
 		static const u32 invalid = base > 0 ? 0 : -1;
 
 		static_assert(u64{step} * count + base < UINT32_MAX, "ID traits: invalid object range");
+		static_assert(count <= 65536, "ID traits: too many IDs");
 	};
 
 	// Optional object initialization function (called after ID registration)
@@ -149,7 +149,260 @@ namespace id_manager
 		}
 	};
 
-	using id_map = std::map<id_key, std::shared_ptr<void>>;
+	// Object table for one ID type: slot N holds the object with ID N * step + base (O(1) lookup)
+	// Slots are allocated in chunks which are never moved or freed while the table exists, so they can be read without the lock
+	class id_map
+	{
+	public:
+		static constexpr u32 chunk_size = 256;
+		static constexpr u32 max_chunks = 256; // Up to 65536 IDs
+
+		struct slot
+		{
+			// Bit 0: occupied, bits 1..31: generation (changes on every allocation and removal), bits 32..63: true object type
+			atomic_t<u64> tag{0};
+
+			// Object, modified only under the writer lock via std::atomic_store (paired with std::atomic_load in lock-free readers)
+			std::shared_ptr<void> ptr;
+
+			u32 id; // Constant
+
+			bool occupied() const
+			{
+				return (tag.load() & 1) != 0;
+			}
+
+			u32 type() const
+			{
+				return static_cast<u32>(tag.load() >> 32);
+			}
+		};
+
+		using pointer = slot*;
+
+	private:
+		atomic_t<slot*> m_chunks[max_chunks]{};
+		u32 m_end = 0; // Index after the last occupied slot
+		u32 m_count = 0; // Number of occupied slots
+		u32 m_base = 0;
+		u32 m_step = 1;
+
+		// Get slot (returns nullptr if not allocated)
+		slot* at(u32 index) const
+		{
+			if (UNLIKELY(index >= chunk_size * max_chunks))
+			{
+				return nullptr;
+			}
+
+			if (slot* chunk = m_chunks[index / chunk_size].load())
+			{
+				return chunk + index % chunk_size;
+			}
+
+			return nullptr;
+		}
+
+		static u32 next_generation(const slot& place)
+		{
+			return (static_cast<u32>(place.tag.load()) + 2) & ~1u;
+		}
+
+	public:
+		id_map() = default;
+
+		// Only used by idm::init() before any ID is allocated
+		id_map(id_map&& other)
+			: m_end(other.m_end)
+			, m_count(other.m_count)
+			, m_base(other.m_base)
+			, m_step(other.m_step)
+		{
+			for (u32 i = 0; i < max_chunks; i++)
+			{
+				m_chunks[i].raw() = other.m_chunks[i].raw();
+				other.m_chunks[i].raw() = nullptr;
+			}
+		}
+
+		~id_map()
+		{
+			for (auto& chunk : m_chunks)
+			{
+				delete[] chunk.raw();
+			}
+		}
+
+		// Get slot index (returns -1 if ID is out of range)
+		static u32 index(u32 id, u32 base, u32 step)
+		{
+			const u32 diff = id - base;
+
+			if (UNLIKELY(id < base || diff % step))
+			{
+				return -1;
+			}
+
+			return diff / step;
+		}
+
+		// Reserve new ID (returns nullptr if out of resources)
+		pointer allocate(u32 type, u32 base, u32 step, u32 count)
+		{
+			m_base = base;
+			m_step = step;
+
+			if (m_count >= count)
+			{
+				return nullptr;
+			}
+
+			// Assume next ID after the last one
+			u32 next = m_end < count ? m_end : 0;
+
+			for (; next < count; next++)
+			{
+				slot* place = at(next);
+
+				if (!place)
+				{
+					const u32 first = next - next % chunk_size;
+					const auto chunk = new slot[chunk_size];
+
+					for (u32 i = 0; i < chunk_size; i++)
+					{
+						chunk[i].id = (first + i) * step + base;
+					}
+
+					m_chunks[next / chunk_size].store(chunk);
+					place = chunk + next % chunk_size;
+				}
+				else if (place->occupied())
+				{
+					continue;
+				}
+
+				// Object must be set by the caller
+				place->tag = (u64{type} << 32) | next_generation(*place) | 1;
+				m_end = std::max(m_end, next + 1);
+				m_count++;
+				return place;
+			}
+
+			return nullptr;
+		}
+
+		// Find occupied slot (under the lock)
+		pointer find(u32 id)
+		{
+			slot* place = at(index(id, m_base, m_step));
+
+			if (place && place->occupied())
+			{
+				return place;
+			}
+
+			return nullptr;
+		}
+
+		// Get the object without the lock, retry if the slot was modified concurrently
+		std::shared_ptr<void> load(u32 index, u32 true_type, bool any_type) const
+		{
+			const slot* place = at(index);
+
+			if (!place)
+			{
+				return nullptr;
+			}
+
+			while (true)
+			{
+				const u64 tag = place->tag.load();
+
+				if (!(tag & 1) || (!any_type && static_cast<u32>(tag >> 32) != true_type))
+				{
+					return nullptr;
+				}
+
+				auto result = std::atomic_load(&place->ptr);
+
+				if (LIKELY(place->tag.load() == tag))
+				{
+					return result;
+				}
+			}
+		}
+
+		// Check the slot without the lock (doesn't touch the object)
+		bool test(u32 index, u32 true_type, bool any_type) const
+		{
+			const slot* place = at(index);
+
+			if (!place)
+			{
+				return false;
+			}
+
+			const u64 tag = place->tag.load();
+
+			return (tag & 1) && (any_type || static_cast<u32>(tag >> 32) == true_type);
+		}
+
+		// Set the object of the reserved slot
+		void assign(pointer place, std::shared_ptr<void> ptr)
+		{
+			std::atomic_store(&place->ptr, std::move(ptr));
+		}
+
+		// Free the slot and return the object
+		std::shared_ptr<void> erase(pointer place)
+		{
+			// Invalidate lock-free readers first
+			place->tag = next_generation(*place);
+			m_count--;
+
+			while (m_end && !at(m_end - 1)->occupied())
+			{
+				m_end--;
+			}
+
+			return std::atomic_exchange(&place->ptr, std::shared_ptr<void>{});
+		}
+
+		u32 size() const
+		{
+			return m_count;
+		}
+
+		// Free all slots (chunks are kept)
+		void clear()
+		{
+			for (u32 i = 0, end = m_end; i < end; i++)
+			{
+				if (at(i)->occupied())
+				{
+					erase(at(i));
+				}
+			}
+
+			m_count = 0;
+		}
+
+		// Call func(id_key, std::shared_ptr<void>&) for every occupied slot (in ID order, under the lock)
+		template<typename F>
+		void for_each(F&& func)
+		{
+			for (u32 i = 0; i < m_end; i++)
+			{
+				slot* place = at(i);
+
+				if (place->occupied())
+				{
+					func(id_key(place->id, place->type()), place->ptr);
+				}
+			}
+		}
+	};
 }
 
 // Object manager for emulated process. Multiple objects of specified arbitrary type are given unique IDs.
@@ -238,9 +491,27 @@ class idm
 	// Get ID (additionally check true_type if not equal)
 	static id_manager::id_map::pointer find_id(u32 type, u32 true_type, u32 id);
 
-	// Allocate new ID and assign the object from the provider()
+	// Get the object without the lock (additionally check true_type if not equal)
+	template<typename T, typename Get>
+	static inline std::shared_ptr<void> load_id(u32 id)
+	{
+		const u32 index = id_manager::id_map::index(id, id_manager::id_traits<T>::base, id_manager::id_traits<T>::step);
+
+		return g_map[get_type<T>()].load(index, get_type<Get>(), std::is_same<T, Get>::value);
+	}
+
+	// Check the ID without the lock (additionally check true_type if not equal)
+	template<typename T, typename Get>
+	static inline bool test_id(u32 id)
+	{
+		const u32 index = id_manager::id_map::index(id, id_manager::id_traits<T>::base, id_manager::id_traits<T>::step);
+
+		return g_map[get_type<T>()].test(index, get_type<Get>(), std::is_same<T, Get>::value);
+	}
+
+	// Allocate new ID and assign the object from the provider(), return the ID and the object copied under the lock
 	template<typename T, typename Type, typename F>
-	static id_manager::id_map::pointer create_id(F&& provider)
+	static std::pair<id_manager::id_key, std::shared_ptr<void>> create_id(F&& provider)
 	{
 		writer_lock lock(id_manager::g_mutex);
 
@@ -256,17 +527,18 @@ class idm
 			try
 			{
 				// Get object, store it
-				place->second = provider();
-				return place;
+				auto ptr = provider();
+				g_map[types.first].assign(place, ptr);
+				return {id_manager::id_key(place->id, types.second), std::move(ptr)};
 			}
 			catch (...)
 			{
-				delete_id(types.first, types.first, place->first.id());
+				delete_id(types.first, types.first, place->id);
 				throw;
 			}
 		}
 
-		return nullptr;
+		return {id_manager::id_key(-1), nullptr};
 	}
 
 public:
@@ -286,11 +558,13 @@ public:
 	template<typename T, typename Make = T, typename... Args>
 	static inline std::enable_if_t<std::is_constructible<Make, Args...>::value, std::shared_ptr<Make>> make_ptr(Args&&... args)
 	{
-		if (auto pair = create_id<T, Make>([&] { return std::make_shared<Make>(std::forward<Args>(args)...); }))
+		const auto pair = create_id<T, Make>([&] { return std::make_shared<Make>(std::forward<Args>(args)...); });
+
+		if (pair.first.id() != -1)
 		{
-			id_manager::on_init<T>::func(static_cast<T*>(pair->second.get()), pair->second);
+			id_manager::on_init<T>::func(static_cast<T*>(pair.second.get()), pair.second);
 			id_manager::on_stop<T>::func(nullptr);
-			return{ pair->second, static_cast<Make*>(pair->second.get()) };
+			return{ pair.second, static_cast<Make*>(pair.second.get()) };
 		}
 
 		return nullptr;
@@ -300,11 +574,13 @@ public:
 	template<typename T, typename Make = T, typename... Args>
 	static inline std::enable_if_t<std::is_constructible<Make, Args...>::value, u32> make(Args&&... args)
 	{
-		if (auto pair = create_id<T, Make>([&] { return std::make_shared<Make>(std::forward<Args>(args)...); }))
+		const auto pair = create_id<T, Make>([&] { return std::make_shared<Make>(std::forward<Args>(args)...); });
+
+		if (pair.first.id() != -1)
 		{
-			id_manager::on_init<T>::func(static_cast<T*>(pair->second.get()), pair->second);
+			id_manager::on_init<T>::func(static_cast<T*>(pair.second.get()), pair.second);
 			id_manager::on_stop<T>::func(nullptr);
-			return pair->first.id();
+			return pair.first.id();
 		}
 
 		return id_manager::id_traits<T>::invalid;
@@ -314,11 +590,13 @@ public:
 	template<typename T, typename Made = T>
 	static inline u32 import_existing(const std::shared_ptr<T>& ptr)
 	{
-		if (auto pair = create_id<T, Made>([&] { return ptr; }))
+		const auto pair = create_id<T, Made>([&] { return ptr; });
+
+		if (pair.first.id() != -1)
 		{
-			id_manager::on_init<T>::func(static_cast<T*>(pair->second.get()), pair->second);
+			id_manager::on_init<T>::func(static_cast<T*>(pair.second.get()), pair.second);
 			id_manager::on_stop<T>::func(nullptr);
-			return pair->first.id();
+			return pair.first.id();
 		}
 
 		return id_manager::id_traits<T>::invalid;
@@ -328,23 +606,23 @@ public:
 	template<typename T, typename Made = T, typename F, typename = std::result_of_t<F()>>
 	static inline std::shared_ptr<Made> import(F&& provider)
 	{
-		if (auto pair = create_id<T, Made>(std::forward<F>(provider)))
+		const auto pair = create_id<T, Made>(std::forward<F>(provider));
+
+		if (pair.first.id() != -1)
 		{
-			id_manager::on_init<T>::func(static_cast<T*>(pair->second.get()), pair->second);
+			id_manager::on_init<T>::func(static_cast<T*>(pair.second.get()), pair.second);
 			id_manager::on_stop<T>::func(nullptr);
-			return { pair->second, static_cast<Made*>(pair->second.get()) };
+			return { pair.second, static_cast<Made*>(pair.second.get()) };
 		}
 
 		return nullptr;
 	}
 
-	// Check the ID
+	// Check the ID (lock-free)
 	template<typename T, typename Get = T>
 	static inline explicit_bool_t check(u32 id)
 	{
-		reader_lock lock(id_manager::g_mutex);
-
-		return find_id(get_type<T>(), get_type<Get>(), id) != nullptr;
+		return test_id<T, Get>(id);
 	}
 
 	// Check the ID, access object under shared lock
@@ -360,7 +638,7 @@ public:
 			return false;
 		}
 
-		func(*static_cast<Get*>(found->second.get()));
+		func(*static_cast<Get*>(found->ptr.get()));
 		return true;
 	}
 
@@ -377,23 +655,21 @@ public:
 			return {false};
 		}
 
-		return {true, func(*static_cast<Get*>(found->second.get()))};
+		return {true, func(*static_cast<Get*>(found->ptr.get()))};
 	}
 
-	// Get the object
+	// Get the object (lock-free)
 	template<typename T, typename Get = T, typename Made = std::conditional_t<std::is_void<Get>::value, T, Get>>
 	static inline std::shared_ptr<Made> get(u32 id)
 	{
-		reader_lock lock(id_manager::g_mutex);
-
-		const auto found = find_id(get_type<T>(), get_type<Get>(), id);
+		const auto found = load_id<T, Get>(id);
 
 		if (UNLIKELY(found == nullptr))
 		{
 			return nullptr;
 		}
 
-		return {found->second, static_cast<Made*>(found->second.get())};
+		return {found, static_cast<Made*>(found.get())};
 	}
 
 	// Get the object, access object under reader lock
@@ -411,11 +687,11 @@ public:
 			return result_type{nullptr};
 		}
 
-		const auto ptr = static_cast<Get*>(found->second.get());
+		const auto ptr = static_cast<Get*>(found->ptr.get());
 
 		func(*ptr);
 
-		return result_type{found->second, ptr};
+		return result_type{found->ptr, ptr};
 	}
 
 	// Get the object, access object under reader lock, propagate return value
@@ -433,9 +709,9 @@ public:
 			return result_type{nullptr};
 		}
 
-		const auto ptr = static_cast<Get*>(found->second.get());
+		const auto ptr = static_cast<Get*>(found->ptr.get());
 
-		return result_type{{found->second, ptr}, func(*ptr)};
+		return result_type{{found->ptr, ptr}, func(*ptr)};
 	}
 
 	// Access all objects of specified types under reader lock (use lambda or callable object), return the number of objects processed
@@ -448,11 +724,11 @@ public:
 
 		for (u32 type : { get_type<Types>()... })
 		{
-			for (auto& id : g_map[type])
+			g_map[type].for_each([&](id_manager::id_key key, std::shared_ptr<void>& ptr)
 			{
-				func(id.first.id(), *static_cast<typename function_traits<FT>::object_type*>(id.second.get()));
+				func(key.id(), *static_cast<typename function_traits<FT>::object_type*>(ptr.get()));
 				result++;
-			}
+			});
 		}
 
 		return result;
@@ -467,18 +743,30 @@ public:
 
 		reader_lock lock(id_manager::g_mutex);
 
+		result_type found{nullptr};
+
 		for (u32 type : { get_type<Types>()... })
 		{
-			for (auto& id : g_map[type])
+			g_map[type].for_each([&](id_manager::id_key key, std::shared_ptr<void>& ptr)
 			{
-				if (FRT result = func(id.first.id(), *static_cast<object_type*>(id.second.get())))
+				if (found)
 				{
-					return result_type{{id.second, static_cast<object_type*>(id.second.get())}, std::move(result)};
+					return;
 				}
+
+				if (FRT result = func(key.id(), *static_cast<object_type*>(ptr.get())))
+				{
+					found = result_type{{ptr, static_cast<object_type*>(ptr.get())}, std::move(result)};
+				}
+			});
+
+			if (found)
+			{
+				break;
 			}
 		}
 
-		return result_type{nullptr};
+		return found;
 	}
 
 	// Get count of objects
@@ -493,14 +781,14 @@ public:
 		}
 
 		u32 result = 0;
-		
-		for (auto& id : g_map[get_type<T>()])
+
+		g_map[get_type<T>()].for_each([&](id_manager::id_key key, std::shared_ptr<void>&)
 		{
-			if (id.first.type() == get_type<Get>())
+			if (key.type() == get_type<Get>())
 			{
 				result++;
 			}
-		}
+		});
 
 		return result;
 	}
@@ -509,7 +797,12 @@ public:
 	template<typename T, typename Get = T>
 	static inline explicit_bool_t remove(u32 id)
 	{
-		auto ptr = delete_id(get_type<T>(), get_type<Get>(), id);
+		std::shared_ptr<void> ptr;
+		{
+			writer_lock lock(id_manager::g_mutex);
+
+			ptr = delete_id(get_type<T>(), get_type<Get>(), id);
+		}
 
 		if (LIKELY(ptr))
 		{
@@ -523,7 +816,12 @@ public:
 	template<typename T, typename Get = T>
 	static inline std::shared_ptr<Get> withdraw(u32 id)
 	{
-		auto ptr = delete_id(get_type<T>(), get_type<Get>(), id);
+		std::shared_ptr<void> ptr;
+		{
+			writer_lock lock(id_manager::g_mutex);
+
+			ptr = delete_id(get_type<T>(), get_type<Get>(), id);
+		}
 
 		if (LIKELY(ptr))
 		{
@@ -550,11 +848,9 @@ public:
 				return result_type{nullptr};
 			}
 
-			func(*static_cast<Get*>(found->second.get()));
+			func(*static_cast<Get*>(found->ptr.get()));
 
 			ptr = delete_id(get_type<T>(), get_type<Get>(), id);
-
-			g_map[get_type<T>()].erase(id);
 		}
 
 		id_manager::on_stop<T>::func(static_cast<T*>(ptr.get()));
@@ -580,18 +876,16 @@ public:
 				return result_type{nullptr};
 			}
 
-			const auto _ptr = static_cast<Get*>(found->second.get());
+			const auto _ptr = static_cast<Get*>(found->ptr.get());
 
 			ret = func(*_ptr);
 
 			if (ret)
 			{
-				return result_type{{found->second, _ptr}, std::move(ret)};
+				return result_type{{found->ptr, _ptr}, std::move(ret)};
 			}
 
 			ptr = delete_id(get_type<T>(), get_type<Get>(), id);
-
-			g_map[get_type<T>()].erase(id);
 		}
 		
 		id_manager::on_stop<T>::func(static_cast<T*>(ptr.get()));
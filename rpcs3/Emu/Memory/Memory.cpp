@@ -39,6 +39,7 @@ u32 VirtualMemoryBlock::Map(u32 realaddr, u32 size)
 		if (!is_good_addr) continue;
 
 		m_mapped_memory.emplace_back(addr, realaddr, size);
+		UpdateTables();
 
 		return addr;
 	}
@@ -64,6 +65,7 @@ bool VirtualMemoryBlock::Map(u32 realaddr, u32 size, u32 addr)
 	}
 
 	m_mapped_memory.emplace_back(addr, realaddr, size);
+	UpdateTables();
 	return true;
 }
 
@@ -75,6 +77,7 @@ bool VirtualMemoryBlock::UnmapRealAddress(u32 realaddr, u32& size)
 		{
 			size = m_mapped_memory[i].size;
 			m_mapped_memory.erase(m_mapped_memory.begin() + i);
+			UpdateTables();
 			return true;
 		}
 	}
@@ -90,6 +93,7 @@ bool VirtualMemoryBlock::UnmapAddress(u32 addr, u32& size)
 		{
 			size = m_mapped_memory[i].size;
 			m_mapped_memory.erase(m_mapped_memory.begin() + i);
+			UpdateTables();
 			return true;
 		}
 	}
@@ -115,7 +119,7 @@ bool VirtualMemoryBlock::Write32(const u32 addr, const u32 value)
 	return true;
 }
 
-bool VirtualMemoryBlock::getRealAddr(u32 addr, u32& result)
+bool VirtualMemoryBlock::getRealAddrSlow(u32 addr, u32& result)
 {
 	for (u32 i = 0; i<m_mapped_memory.size(); ++i)
 	{
@@ -129,7 +133,7 @@ bool VirtualMemoryBlock::getRealAddr(u32 addr, u32& result)
 	return false;
 }
 
-u32 VirtualMemoryBlock::getMappedAddress(u32 realAddress)
+u32 VirtualMemoryBlock::getMappedAddressSlow(u32 realAddress)
 {
 	for (u32 i = 0; i<m_mapped_memory.size(); ++i)
 	{
@@ -142,6 +146,52 @@ u32 VirtualMemoryBlock::getMappedAddress(u32 realAddress)
 	return 0;
 }
 
+void VirtualMemoryBlock::UpdateTables()
+{
+	// A page is translated directly if the first mapping (in search order) touching it covers it entirely
+	auto build = [&](std::array<u32, 0x1000>& table, bool real)
+	{
+		std::array<u32, 0x1000> result;
+		result.fill(page_unmapped);
+
+		for (const auto& info : m_mapped_memory)
+		{
+			const u32 from = real ? info.realAddress : info.addr;
+			const u32 to = real ? info.addr : info.realAddress;
+			const u64 end = u64{from} + info.size;
+
+			for (u64 page = from >> 20; page < (end + 0xfffff) >> 20 && page < 0x1000; page++)
+			{
+				if (result[page] != page_unmapped)
+				{
+					continue;
+				}
+
+				if (from <= page << 20 && end >= (page + 1) << 20)
+				{
+					result[page] = static_cast<u32>(to + ((page << 20) - from));
+				}
+				else
+				{
+					result[page] = page_partial;
+				}
+			}
+		}
+
+		// Update entries in place (may be read concurrently)
+		for (u32 i = 0; i < 0x1000; i++)
+		{
+			if (table[i] != result[i])
+			{
+				table[i] = result[i];
+			}
+		}
+	};
+
+	build(m_real_table, false);
+	build(m_mapped_table, true);
+}
+
 bool VirtualMemoryBlock::Reserve(u32 size)
 {
 	if (size + GetReservedAmount() > m_range_size)
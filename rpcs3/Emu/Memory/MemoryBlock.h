@@ -42,13 +42,31 @@ class VirtualMemoryBlock
 	u32 m_range_start = 0;
 	u32 m_range_size = 0;
 
+	// Translation tables (1 MB pages): base address of the page in the other address space, or one of the following values
+	static const u32 page_unmapped = 0xffffffff; // No mapping in the page
+	static const u32 page_partial = 0xfffffffe; // Not fully covered by the first mapping (linear search)
+
+	std::array<u32, 0x1000> m_real_table; // Mapped address -> real address
+	std::array<u32, 0x1000> m_mapped_table; // Real address -> mapped address
+
+	// Rebuild translation tables after the mappings are changed
+	void UpdateTables();
+
+	bool getRealAddrSlow(u32 addr, u32& result);
+	u32 getMappedAddressSlow(u32 realAddress);
+
 public:
-	VirtualMemoryBlock() = default;
+	VirtualMemoryBlock()
+	{
+		m_real_table.fill(page_unmapped);
+		m_mapped_table.fill(page_unmapped);
+	}
 
 	VirtualMemoryBlock* SetRange(const u32 start, const u32 size);
-	void Clear() { m_mapped_memory.clear(); m_reserve_size = 0; m_range_start = 0; m_range_size = 0; }
+	void Clear() { m_mapped_memory.clear(); m_reserve_size = 0; m_range_start = 0; m_range_size = 0; UpdateTables(); }
 	u32 GetStartAddr() const { return m_range_start; }
 	u32 GetSize() const { return m_range_size; }
+	const std::vector<VirtualMemInfo>& GetMappedMemory() const { return m_mapped_memory; }
 	bool IsInMyRange(const u32 addr, const u32 size);
 
 	// maps real address to virtual address space, returns the mapped address or 0 on failure (if no address is specified the
@@ -77,7 +95,18 @@ public:
 
 	// try to get the real address given a mapped address
 	// return true for success
-	bool getRealAddr(u32 addr, u32& result);
+	bool getRealAddr(u32 addr, u32& result)
+	{
+		const u32 base = m_real_table[addr >> 20];
+
+		if (LIKELY(base < page_partial))
+		{
+			result = base + (addr & 0xfffff);
+			return true;
+		}
+
+		return base == page_partial && getRealAddrSlow(addr, result);
+	}
 
 	u32 RealAddr(u32 addr)
 	{
@@ -93,5 +122,15 @@ public:
 	}
 
 	// return the mapped address given a real address, if not mapped return 0
-	u32 getMappedAddress(u32 realAddress);
+	u32 getMappedAddress(u32 realAddress)
+	{
+		const u32 base = m_mapped_table[realAddress >> 20];
+
+		if (LIKELY(base < page_partial))
+		{
+			return base + (realAddress & 0xfffff);
+		}
+
+		return base == page_partial ? getMappedAddressSlow(realAddress) : 0;
+	}
 };
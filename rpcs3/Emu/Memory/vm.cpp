@@ -1,6 +1,7 @@
 ﻿#include "stdafx.h"
 #include "Memory.h"
 #include "Emu/System.h"
+#include "Emu/Benchmark.h"
 #include "Utilities/Thread.h"
 
 #ifdef _WIN32
@@ -208,6 +209,7 @@ namespace vm
 		if (g_reservation_owner != thread_ctrl::get_current() || g_reservation_addr != addr || g_reservation_size != size)
 		{
 			// atomic update failed
+			if (UNLIKELY(g_perf_counters.enabled)) g_perf_counters.reservation_failure++;
 			return false;
 		}
 
@@ -224,6 +226,7 @@ namespace vm
 		lock.unlock(), vm::notify_at(addr, size);
 
 		// atomic update succeeded
+		if (UNLIKELY(g_perf_counters.enabled)) g_perf_counters.reservation_success++;
 		return true;
 	}
 
@@ -422,6 +425,28 @@ namespace vm
 		return true;
 	}
 
+	bool page_check(u32 addr, u32 size, u8 flags_test, u8 flags_clear)
+	{
+		if (!size || (size | addr) % 4096)
+		{
+			fmt::throw_exception("Invalid arguments (addr=0x%x, size=0x%x)" HERE, addr, size);
+		}
+
+		flags_test |= page_allocated;
+
+		for (u32 i = addr / 4096; i < addr / 4096 + size / 4096; i++)
+		{
+			const u8 flags = g_pages[i];
+
+			if ((flags & flags_test) != flags_test || (flags & flags_clear) != 0)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
 	void _page_unmap(u32 addr, u32 size)
 	{
 		if (!size || (size | addr) % 4096)
@@ -76,6 +76,9 @@ namespace vm
 	// Change memory protection of specified memory region
 	bool page_protect(u32 addr, u32 size, u8 flags_test = 0, u8 flags_set = 0, u8 flags_clear = 0);
 
+	// Test whether all pages of specified memory region are allocated, have flags_test set and flags_clear cleared
+	bool page_check(u32 addr, u32 size, u8 flags_test = 0, u8 flags_clear = 0);
+
 	// Check if existing memory range is allocated. Checking address before using it is very unsafe.
 	// Return value may be wrong. Even if it's true and correct, actual memory protection may be read-only and no-access.
 	bool check_addr(u32 addr, u32 size = 1);
@@ -3,6 +3,8 @@
 #include "../../../Utilities/BitField.h"
 
 #include <set>
+#include <map>
+#include <numeric>
 
 enum class arm_encoding
 {
@@ -1674,13 +1676,150 @@ class arm_decoder
 		}
 	};
 
-	// Lookup table for 4-byte Thumb instructions (points to the best appropriate position in sorted vector)
-	std::array<typename std::vector<instruction_info>::const_iterator, 0x10000> m_op32_table{};
+	// Decoding table entry: the instruction if the entry is fully decoded, otherwise the candidates to check in order
+	struct table_entry
+	{
+		T pointer;
+		u32 first; // Position in m_candidates
+		u32 count;
+	};
+
+	// Second level table, indexed by a bit window of the opcode
+	struct table_group
+	{
+		u32 shift;
+		u32 mask;
+		u32 base; // Position in m_entries
+	};
+
+	// First level tables (4-byte Thumb: first halfword, ARM: bits 20..27 and unconditional flag)
+	std::array<u16, 0x10000> m_op32_table{};
+	std::array<u16, 0x200> m_arm_table{};
+
+	std::vector<table_group> m_groups;
+	std::vector<table_entry> m_entries;
+	std::vector<instruction_info> m_candidates;
 
 	std::vector<instruction_info> m_op16_list;
 	std::vector<instruction_info> m_op32_list;
 	std::vector<instruction_info> m_arm_list;
 
+	// Build the second level table for the instructions which can match the key (groups with the same candidates are shared)
+	u16 make_group(const std::vector<instruction_info>& list, u32 key_mask, u32 key, u32 max_shift, std::map<std::vector<u32>, u16>& groups)
+	{
+		std::vector<u32> indices;
+
+		for (u32 i = 0; i < list.size(); i++)
+		{
+			if (((list[i].code ^ key) & list[i].mask & key_mask) == 0)
+			{
+				indices.push_back(i);
+			}
+		}
+
+		const auto found = groups.find(indices);
+
+		if (found != groups.end())
+		{
+			return found->second;
+		}
+
+		// Select the bit window most used by the candidates (besides the key)
+		u32 shift = 0, width = 0;
+
+		if (indices.size() > 1)
+		{
+			u32 weights[32]{};
+
+			for (u32 i : indices)
+			{
+				for (u32 bit = 0; bit < 32; bit++)
+				{
+					weights[bit] += (list[i].mask & ~key_mask) >> bit & 1;
+				}
+			}
+
+			u32 best = 0;
+			width = 8;
+
+			for (u32 sh = 0; sh <= max_shift; sh++)
+			{
+				const u32 sum = std::accumulate(weights + sh, weights + sh + width, 0u);
+
+				if (sum > best)
+				{
+					best = sum;
+					shift = sh;
+				}
+			}
+		}
+
+		const u32 mask = (1u << width) - 1;
+		const u16 result = ::narrow<u16>(m_groups.size());
+
+		m_groups.push_back({ shift, mask, ::size32(m_entries) });
+
+		for (u32 value = 0; value <= mask; value++)
+		{
+			const u32 covered = key_mask | mask << shift;
+
+			table_entry entry{ &D::UNK, ::size32(m_candidates), 0 };
+
+			for (u32 i : indices)
+			{
+				const auto& info = list[i];
+
+				if ((info.code ^ value << shift) & info.mask & mask << shift)
+				{
+					continue;
+				}
+
+				// Always matches if no other bits must be checked
+				const bool decoded = (info.mask & ~covered) == 0 && !info.skip;
+
+				if (decoded && entry.count == 0)
+				{
+					entry.pointer = info.pointer;
+					break;
+				}
+
+				entry.pointer = nullptr;
+				entry.count++;
+				m_candidates.push_back(info);
+
+				if (decoded)
+				{
+					break;
+				}
+			}
+
+			m_entries.push_back(entry);
+		}
+
+		groups.emplace(std::move(indices), result);
+		return result;
+	}
+
+	T decode_table(const table_group& group, u32 op) const
+	{
+		const auto& entry = m_entries[group.base + (op >> group.shift & group.mask)];
+
+		if (LIKELY(entry.pointer))
+		{
+			return entry.pointer;
+		}
+
+		for (u32 i = entry.first; i < entry.first + entry.count; i++)
+		{
+			if (m_candidates[i].match(op))
+			{
+				return m_candidates[i].pointer;
+			}
+		}
+
+		return &D::UNK;
+	}
+
 public:
 	arm_decoder()
 	{
@@ -2521,8 +2660,6 @@ public:
 			{ 0x0fffffff, 0x0320f001, fix(&D:: template YIELD<A1>) },
 		});
 
-		m_op32_table.fill(m_op32_list.cbegin());
-
 		for (u32 i = 0; i < 0x10000; i++)
 		{
 			for (auto& opcode : m_op16_list)
@@ -2540,37 +2677,44 @@ public:
 			}
 		}
 
-		std::set<std::set<const instruction_info*>> result;
-		
 		for (u32 i = 0xe800; i < 0x10000; i++)
 		{
 			if (m_op16_table[i]) LOG_ERROR(ARMv7, "Invalid m_op16_table entry 0x%04x", i);
+		}
+
+		// Group 0 (empty) is used for invalid first halfwords
+		std::map<std::vector<u32>, u16> op32_groups;
+		std::map<std::vector<u32>, u16> arm_groups;
 
-			//std::set<const instruction_info*> matches;
-
-			//for (u32 j = 0; j < 0x10000; j++)
-			//{
-			//	for (auto& o : m_op32_list)
-			//	{
-			//		if (o.match(i << 16 | j))
-			//		{
-			//			matches.emplace(&o);
-			//			break;
-			//		}
-			//	}
-			//}
-
-			//result.emplace(std::move(matches));
+		make_group({}, 0, 0, 0, op32_groups);
+
+		for (u32 i = 0xe800; i < 0x10000; i++)
+		{
+			m_op32_table[i] = make_group(m_op32_list, 0xffff0000, i << 16, 8, op32_groups);
 		}
 
-		for (const auto& s : result)
+		// Conditional instructions can't match the unconditional encoding space, and vice versa
+		std::vector<instruction_info> arm_cond_list;
+
+		for (const auto& info : m_arm_list)
 		{
-			LOG_NOTICE(ARMv7, "Set found (%u):", s.size());
-			for (const auto& e : s)
+			if ((info.mask & info.code) >> 28 != 0xf)
 			{
-				LOG_NOTICE(ARMv7, "** 0x%08x, 0x%08x", e->mask, e->code);
+				arm_cond_list.push_back(info);
 			}
 		}
+
+		for (u32 i = 0; i < 0x100; i++)
+		{
+			m_arm_table[i] = make_group(arm_cond_list, 0x0ff00000, i << 20, 20, arm_groups);
+		}
+
+		arm_groups.clear();
+
+		for (u32 i = 0; i < 0x100; i++)
+		{
+			m_arm_table[i | 0x100] = make_group(m_arm_list, 0xfff00000, 0xf0000000 | i << 20, 20, arm_groups);
+		}
 	}
 
 	// First chance
@@ -2582,28 +2726,12 @@ public:
 	// Second step
 	T decode_thumb(u32 op32) const
 	{
-		for (auto i = m_op32_table[op32 >> 16], end = m_op32_list.end(); i != end; i++)
-		{
-			if (i->match(op32))
-			{
-				return i->pointer;
-			}
-		}
-
-		return &D::UNK;
+		return decode_table(m_groups[m_op32_table[op32 >> 16]], op32);
 	}
 
 	T decode_arm(u32 op) const
 	{
-		for (auto& i : m_arm_list)
-		{
-			if (i.match(op))
-			{
-				return i.pointer;
-			}
-		}
-
-		return &D::UNK;
+		return decode_table(m_groups[m_arm_table[(op >> 20 & 0xff) | ((op >> 28) == 0xf) << 8]], op);
 	}
 };
 
@@ -11,6 +11,22 @@ namespace vm { using namespace psv; }
 
 const arm_decoder<arm_interpreter> s_arm_interpreter;
 
+// Get the predecoded instruction or decode it
+template<typename F>
+static inline auto arm_decode_cached(ARMv7Thread& cpu, u32 tag, u32 op, F decode)
+{
+	auto& entry = cpu.decoded[(tag >> 1) % cpu.decoded.size()];
+
+	if (UNLIKELY(entry.tag != tag || entry.op != op))
+	{
+		entry.tag = tag;
+		entry.op = op;
+		entry.func = decode(op);
+	}
+
+	return entry.func;
+}
+
 std::string ARMv7Thread::get_name() const
 {
 	return fmt::format("ARMv7[0x%x] Thread (%s)", id, m_name);
@@ -68,7 +84,7 @@ void ARMv7Thread::cpu_task_main()
 			{
 				const u32 op32 = (op16 << 16) | vm::read16(PC + 2);
 
-				s_arm_interpreter.decode_thumb(op32)(*this, op32, cond);
+				arm_decode_cached(*this, PC | 1, op32, [](u32 op) { return s_arm_interpreter.decode_thumb(op); })(*this, op32, cond);
 				PC += 4;
 			}
 		}
@@ -76,7 +92,7 @@ void ARMv7Thread::cpu_task_main()
 		{
 			const u32 op = vm::read32(PC);
 
-			s_arm_interpreter.decode_arm(op)(*this, op, op >> 28);
+			arm_decode_cached(*this, PC, op, [](u32 op) { return s_arm_interpreter.decode_arm(op); })(*this, op, op >> 28);
 			PC += 4;
 		}
 		else
@@ -143,6 +143,17 @@ public:
 
 	const char* last_function = nullptr;
 
+	// Predecoded 4-byte instruction (the opcode is compared to detect modified code)
+	struct decoded_instruction
+	{
+		u32 tag = -1; // Address | 1 for Thumb
+		u32 op = 0;
+		void(*func)(ARMv7Thread&, const u32 op, const u32 cond) = nullptr;
+	};
+
+	// Direct-mapped by address
+	std::array<decoded_instruction, 0x1000> decoded{};
+
 	void write_pc(u32 value, u32 size)
 	{
 		ISET = value & 1 ? Thumb : ARM;
@@ -33,9 +33,9 @@ namespace
 	}
 
 	template <typename U, typename T>
-	void copy_whole_attribute_array(gsl::span<T> dst, gsl::span<const gsl::byte> src_ptr, u8 attribute_size, u8 dst_stride, u32 src_stride, u32 vertex_count)
+	void copy_whole_attribute_array(gsl::span<T> dst, gsl::span<const gsl::byte> src_ptr, u8 attribute_size, u8 dst_stride, u32 src_stride, u32 first, u32 vertex_count)
 	{
-		for (u32 vertex = 0; vertex < vertex_count; ++vertex)
+		for (u32 vertex = first; vertex < vertex_count; ++vertex)
 		{
 			gsl::span<const U> src = gsl::as_span<const U>(src_ptr.subspan(src_stride * vertex, attribute_size * sizeof(const U)));
 			for (u32 i = 0; i < attribute_size; ++i)
@@ -44,6 +44,131 @@ namespace
 			}
 		}
 	}
+
+	// PSHUFB masks swapping the byte order of 1, 2 and 4 byte elements
+	const __m128i s_bswap_mask[3]
+	{
+		_mm_set_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0),
+		_mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1),
+		_mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3),
+	};
+
+	/**
+	 * Copy and byteswap attributes of ElemSize bytes elements with SSSE3.
+	 * Returns the number of vertices processed, the remaining ones must be handled by the scalar path
+	 * (the last vertices may be too close to the end of the source or destination for 16 bytes accesses).
+	 * Unused components of the destination vertex are set to pad_value (see prepare_buffer_for_writing).
+	 */
+	template <u32 ElemSize>
+	u32 copy_whole_attribute_array_sse(gsl::span<gsl::byte> dst, gsl::span<const gsl::byte> src, u8 attribute_size, u8 dst_stride, u32 src_stride, u32 vertex_count, u32 pad_value)
+	{
+		const __m128i bswap = s_bswap_mask[ElemSize / 2];
+		const u32 size = attribute_size * ElemSize;
+
+		if (size > 16 || size > dst_stride)
+		{
+			return 0;
+		}
+
+		const auto src_data = reinterpret_cast<const u8*>(src.data());
+		const auto dst_data = reinterpret_cast<u8*>(dst.data());
+		const u32 src_size = ::narrow<u32>(src.size_bytes());
+		const u32 dst_size = ::narrow<u32>(dst.size_bytes());
+
+		// Tightly packed source and destination: byteswap the whole array as a single stream
+		if (src_stride == size && dst_stride == size)
+		{
+			const u32 total = std::min(size * vertex_count, std::min(src_size, dst_size));
+			u32 pos = 0;
+
+			for (; pos + 16 <= total; pos += 16)
+			{
+				_mm_storeu_si128((__m128i*)(dst_data + pos), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src_data + pos)), bswap));
+			}
+
+			return pos / size;
+		}
+
+		if (dst_size < 16)
+		{
+			return 0;
+		}
+
+		// Strided gather: 16 bytes are stored per vertex, the bytes following the attribute are built in registers
+		// (the destination may be write-combined memory, it's never read). The bytes of the next vertex are overwritten by it.
+		alignas(16) u8 pad_bytes[16];
+
+		for (u32 i = 0; i < 16; i++)
+		{
+			const u32 offset = i % dst_stride;
+			pad_bytes[i] = offset < size ? 0 : static_cast<u8>(pad_value >> (offset % ElemSize * 8));
+		}
+
+		const __m128i keep = _mm_cmplt_epi8(_mm_set_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), _mm_set1_epi8(size));
+		const __m128i padding = _mm_andnot_si128(keep, _mm_load_si128((const __m128i*)pad_bytes));
+
+		u32 vertex = 0;
+
+		for (; vertex < vertex_count; vertex++)
+		{
+			const u32 src_pos = src_stride * vertex;
+			const u32 dst_pos = dst_stride * vertex;
+
+			if (src_pos + 16 > src_size || dst_pos + 16 > dst_size)
+			{
+				break;
+			}
+
+			const __m128i value = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src_data + src_pos)), bswap);
+			_mm_storeu_si128((__m128i*)(dst_data + dst_pos), _mm_or_si128(_mm_and_si128(keep, value), padding));
+		}
+
+		return vertex;
+	}
+
+	/**
+	 * Decode CMP vectors four at a time with SSE2 (see decode_cmp_vector).
+	 * Returns the number of vertices processed.
+	 */
+	u32 decode_cmp_vectors_sse(gsl::span<gsl::byte> dst, gsl::span<const gsl::byte> src, u8 dst_stride, u32 src_stride, u32 vertex_count)
+	{
+		const auto src_data = reinterpret_cast<const u8*>(src.data());
+		const auto dst_data = reinterpret_cast<u8*>(dst.data());
+		const u32 src_size = ::narrow<u32>(src.size_bytes());
+		const u32 dst_size = ::narrow<u32>(dst.size_bytes());
+
+		const auto load = [&](u32 vertex) -> u32
+		{
+			return *reinterpret_cast<const be_t<u32>*>(src_data + src_stride * vertex);
+		};
+
+		u32 vertex = 0;
+
+		for (; vertex + 4 <= vertex_count; vertex += 4)
+		{
+			if (src_stride * (vertex + 3) + 4 > src_size || dst_stride * (vertex + 3) + 8 > dst_size)
+			{
+				break;
+			}
+
+			const __m128i v = _mm_set_epi32(load(vertex + 3), load(vertex + 2), load(vertex + 1), load(vertex));
+			const __m128i mask = _mm_set1_epi32(0x7ff);
+
+			// X | Y << 16 and Z | W << 16 for each vector
+			const __m128i xy = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(v, mask), 5), _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(v, 11), mask), 21));
+			const __m128i zw = _mm_or_si128(_mm_slli_epi32(_mm_srli_epi32(v, 22), 6), _mm_set1_epi32(0x10000));
+
+			const __m128i lo = _mm_unpacklo_epi32(xy, zw);
+			const __m128i hi = _mm_unpackhi_epi32(xy, zw);
+
+			_mm_storel_epi64((__m128i*)(dst_data + dst_stride * vertex), lo);
+			_mm_storel_epi64((__m128i*)(dst_data + dst_stride * (vertex + 1)), _mm_unpackhi_epi64(lo, lo));
+			_mm_storel_epi64((__m128i*)(dst_data + dst_stride * (vertex + 2)), hi);
+			_mm_storel_epi64((__m128i*)(dst_data + dst_stride * (vertex + 3)), _mm_unpackhi_epi64(hi, hi));
+		}
+
+		return vertex;
+	}
 }
 
 void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::span<const gsl::byte> src_ptr, u32 count, rsx::vertex_base_type type, u32 vector_element_count, u32 attribute_src_stride, u8 dst_stride)
@@ -56,7 +181,8 @@ void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::s
 	case rsx::vertex_base_type::ub256:
 	{
 		gsl::span<u8> dst_span = as_span_workaround<u8>(raw_dst_span);
-		copy_whole_attribute_array<u8>(dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, count);
+		const u32 first = copy_whole_attribute_array_sse<1>(raw_dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, count, 0);
+		copy_whole_attribute_array<u8>(dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, first, count);
 		return;
 	}
 	case rsx::vertex_base_type::s1:
@@ -64,19 +190,21 @@ void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::s
 	case rsx::vertex_base_type::s32k:
 	{
 		gsl::span<u16> dst_span = as_span_workaround<u16>(raw_dst_span);
-		copy_whole_attribute_array<be_t<u16>>(dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, count);
+		const u32 first = copy_whole_attribute_array_sse<2>(raw_dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, count, type == rsx::vertex_base_type::sf ? 0x3c00 : 0);
+		copy_whole_attribute_array<be_t<u16>>(dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, first, count);
 		return;
 	}
 	case rsx::vertex_base_type::f:
 	{
 		gsl::span<u32> dst_span = as_span_workaround<u32>(raw_dst_span);
-		copy_whole_attribute_array<be_t<u32>>(dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, count);
+		const u32 first = copy_whole_attribute_array_sse<4>(raw_dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, count, 0x3f800000);
+		copy_whole_attribute_array<be_t<u32>>(dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, first, count);
 		return;
 	}
 	case rsx::vertex_base_type::cmp:
 	{
 		gsl::span<u16> dst_span = as_span_workaround<u16>(raw_dst_span);
-		for (u32 i = 0; i < count; ++i)
+		for (u32 i = decode_cmp_vectors_sse(raw_dst_span, src_ptr, dst_stride, attribute_src_stride, count); i < count; ++i)
 		{
 			be_t<u32> src_value;
 			memcpy(&src_value,
@@ -93,149 +221,315 @@ void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::s
 	}
 }
 
+rsx::upload_cache::key_t get_vertex_array_cache_key(const rsx::vertex_array_buffer& vertex_array, u32 count, u8 dst_stride)
+{
+	rsx::upload_cache::key_t key;
+	key.address = vm::get_addr(vertex_array.data.data());
+	key.size = ::narrow<u32>(vertex_array.data.size_bytes());
+	key.dst_size = count * dst_stride;
+	key.params[0] = 0; // Vertex array
+	key.params[1] = static_cast<u32>(vertex_array.type) | vertex_array.attribute_size << 8 | vertex_array.stride << 16;
+	key.params[2] = dst_stride;
+	return key;
+}
+
+rsx::upload_cache::key_t get_index_array_cache_key(gsl::span<const gsl::byte> src, u32 dst_size, rsx::index_array_type type, rsx::primitive_type draw_mode,
+	bool restart_index_enabled, u32 restart_index, const std::vector<std::pair<u32, u32> > &first_count_arguments)
+{
+	rsx::upload_cache::key_t key;
+	key.address = vm::get_addr(src.data());
+	key.size = ::narrow<u32>(src.size_bytes());
+	key.dst_size = dst_size;
+	key.params[0] = 1 | static_cast<u32>(type) << 8 | static_cast<u32>(draw_mode) << 16 | restart_index_enabled << 24; // Index array
+	key.params[1] = restart_index_enabled ? restart_index : 0;
+	key.params[2] = first_count_arguments.front().first;
+	return key;
+}
+
 namespace
 {
+/**
+ * Converts big endian indices to host order, replaces primitive restart indices with -1 and tracks the min/max index.
+ * Indices are processed 16 bytes at a time with SSSE3, min/max are computed in the signed domain (biased) since SSE4.1 isn't required.
+ */
 template<typename T>
-std::tuple<T, T> upload_untouched(gsl::span<to_be_t<const T>> src, gsl::span<T> dst, bool is_primitive_restart_enabled, T primitive_restart_index)
+class index_processor
 {
-	T min_index = -1;
-	T max_index = 0;
+	static_assert(sizeof(T) == 2 || sizeof(T) == 4, "Unsupported index type");
 
-	verify(HERE), (dst.size_bytes() >= src.size_bytes());
+	const bool m_restart_enabled;
+	const T m_restart_index;
+
+	const __m128i m_bswap;
+	const __m128i m_restart;
+	const __m128i m_enable;
+	const __m128i m_bias;
+
+	__m128i m_min;
+	__m128i m_max;
 
-	size_t dst_idx = 0;
-	for (T index : src)
+	T m_min_index = -1;
+	T m_max_index = 0;
+
+	static __m128i cmpeq(__m128i a, __m128i b)
 	{
-		if (is_primitive_restart_enabled && index == primitive_restart_index)
+		return sizeof(T) == 2 ? _mm_cmpeq_epi16(a, b) : _mm_cmpeq_epi32(a, b);
+	}
+
+	static __m128i min(__m128i a, __m128i b)
+	{
+		if (sizeof(T) == 2)
 		{
-			index = -1;
+			return _mm_min_epi16(a, b);
 		}
-		else
+
+		const __m128i gt = _mm_cmpgt_epi32(a, b);
+		return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+	}
+
+	static __m128i max(__m128i a, __m128i b)
+	{
+		if (sizeof(T) == 2)
 		{
-			max_index = std::max(max_index, index);
-			min_index = std::min(min_index, index);
+			return _mm_max_epi16(a, b);
 		}
-		dst[dst_idx++] = index;
+
+		const __m128i gt = _mm_cmpgt_epi32(a, b);
+		return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
 	}
-	return std::make_tuple(min_index, max_index);
-}
 
-// FIXME: expanded primitive type may not support primitive restart correctly
-template<typename T>
-std::tuple<T, T> expand_indexed_triangle_fan(gsl::span<to_be_t<const T>> src, gsl::span<T> dst, bool is_primitive_restart_enabled, T primitive_restart_index)
-{
-	T min_index = -1;
-	T max_index = 0;
+	static __m128i splat(T value)
+	{
+		return sizeof(T) == 2 ? _mm_set1_epi16(value) : _mm_set1_epi32(value);
+	}
 
-	verify(HERE), (dst.size() >= 3 * (src.size() - 2));
+public:
+	index_processor(bool is_primitive_restart_enabled, u32 primitive_restart_index)
+		: m_restart_enabled(is_primitive_restart_enabled)
+		, m_restart_index(static_cast<T>(primitive_restart_index)) // Truncated to the index type
+		, m_bswap(sizeof(T) == 2
+			? _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1)
+			: _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3))
+		, m_restart(splat(m_restart_index))
+		, m_enable(_mm_set1_epi32(m_restart_enabled ? -1 : 0))
+		, m_bias(splat(T(1) << (sizeof(T) * 8 - 1)))
+		, m_min(_mm_xor_si128(splat(-1), m_bias))
+		, m_max(m_bias)
+	{
+	}
 
-	const T index0 = src[0];
-	if (!is_primitive_restart_enabled || index0 != -1) // Cut
+	// Process 16 bytes of big endian indices
+	__m128i process(const void* src)
 	{
-		min_index = std::min(min_index, index0);
-		max_index = std::max(max_index, index0);
+		const __m128i value = _mm_shuffle_epi8(_mm_loadu_si128(static_cast<const __m128i*>(src)), m_bswap);
+		const __m128i restart = _mm_and_si128(m_enable, cmpeq(value, m_restart));
+		const __m128i result = _mm_or_si128(value, restart);
+
+		// Restarted indices are -1 (no effect on min) and excluded from max
+		m_min = min(m_min, _mm_xor_si128(result, m_bias));
+		m_max = max(m_max, _mm_xor_si128(_mm_andnot_si128(restart, value), m_bias));
+		return result;
 	}
 
-	size_t dst_idx = 0;
-	while (src.size() > 2)
+	// Process single index
+	T process(T index)
 	{
-		gsl::span<to_be_t<const T>> tri_indexes = src.subspan(0, 2);
-		T index1 = tri_indexes[0];
-		if (is_primitive_restart_enabled && index1 == primitive_restart_index)
+		if (m_restart_enabled && index == m_restart_index)
 		{
-			index1 = -1;
+			return -1;
 		}
-		else
-		{
-			min_index = std::min(min_index, index1);
-			max_index = std::max(max_index, index1);
-		}
-		T index2 = tri_indexes[1];
-		if (is_primitive_restart_enabled && index2 == primitive_restart_index)
+
+		m_min_index = std::min(m_min_index, index);
+		m_max_index = std::max(m_max_index, index);
+		return index;
+	}
+
+	std::tuple<T, T> result() const
+	{
+		T min_values[16 / sizeof(T)];
+		T max_values[16 / sizeof(T)];
+		_mm_storeu_si128((__m128i*)min_values, _mm_xor_si128(m_min, m_bias));
+		_mm_storeu_si128((__m128i*)max_values, _mm_xor_si128(m_max, m_bias));
+
+		T min_index = m_min_index;
+		T max_index = m_max_index;
+
+		for (u32 i = 0; i < 16 / sizeof(T); i++)
 		{
-			index2 = -1;
+			min_index = std::min(min_index, min_values[i]);
+			max_index = std::max(max_index, max_values[i]);
 		}
-		else
+
+		return std::make_tuple(min_index, max_index);
+	}
+};
+
+/**
+ * PSHUFB masks expanding a vector of processed indices to triangles.
+ * Quads: 16 bytes of indices (N indices, N / 4 quads) produce 1.5 vectors of (0, 1, 2, 2, 3, 0) triangles.
+ * Fans: N triangles (s0, a[i], b[i]) are built from a = src[k..k+N), b = src[k+1..k+N] and the splatted first index.
+ */
+template<typename T>
+struct index_expand_masks
+{
+	__m128i quad[2];
+	__m128i fan_a[3];
+	__m128i fan_b[3];
+	__m128i fan_0[3];
+
+	index_expand_masks()
+	{
+		const u32 count = 16 / sizeof(T);
+
+		const u32 quad_order[6] = { 0, 1, 2, 2, 3, 0 };
+
+		for (u32 j = 0; j < 3; j++)
 		{
-			min_index = std::min(min_index, index2);
-			max_index = std::max(max_index, index2);
+			u8 quad_bytes[16], a_bytes[16], b_bytes[16], s0_bytes[16];
+
+			for (u32 i = 0; i < 16; i++)
+			{
+				const u32 pos = (j * 16 + i) / sizeof(T);
+				const u32 byte = i % sizeof(T);
+
+				const u32 quad_index = pos / 6 * 4 + quad_order[pos % 6];
+				quad_bytes[i] = pos < count * 6 / 4 ? quad_index * sizeof(T) + byte : 0x80;
+
+				const u32 tri = pos / 3;
+				a_bytes[i] = pos % 3 == 1 ? tri * sizeof(T) + byte : 0x80;
+				b_bytes[i] = pos % 3 == 2 ? tri * sizeof(T) + byte : 0x80;
+				s0_bytes[i] = pos % 3 == 0 ? 0xff : 0;
+			}
+
+			if (j < 2)
+			{
+				quad[j] = _mm_loadu_si128((const __m128i*)quad_bytes);
+			}
+
+			fan_a[j] = _mm_loadu_si128((const __m128i*)a_bytes);
+			fan_b[j] = _mm_loadu_si128((const __m128i*)b_bytes);
+			fan_0[j] = _mm_loadu_si128((const __m128i*)s0_bytes);
 		}
+	}
+};
+
+template<typename T>
+std::tuple<T, T> upload_untouched(gsl::span<to_be_t<const T>> src, gsl::span<T> dst, bool is_primitive_restart_enabled, u32 primitive_restart_index)
+{
+	index_processor<T> indices(is_primitive_restart_enabled, primitive_restart_index);
+
+	verify(HERE), (dst.size_bytes() >= src.size_bytes());
+
+	const u32 count = ::narrow<u32>(src.size());
+	const auto src_data = src.data();
+	const auto dst_data = dst.data();
 
-		dst[dst_idx++] = index0;
-		dst[dst_idx++] = index1;
-		dst[dst_idx++] = index2;
+	u32 i = 0;
 
-		src = src.subspan(2);
+	for (; i + 16 / sizeof(T) <= count; i += 16 / sizeof(T))
+	{
+		_mm_storeu_si128((__m128i*)(dst_data + i), indices.process(src_data + i));
 	}
-	return std::make_tuple(min_index, max_index);
+
+	for (; i < count; i++)
+	{
+		dst_data[i] = indices.process(src_data[i]);
+	}
+
+	return indices.result();
 }
 
 // FIXME: expanded primitive type may not support primitive restart correctly
 template<typename T>
-std::tuple<T, T> expand_indexed_quads(gsl::span<to_be_t<const T>> src, gsl::span<T> dst, bool is_primitive_restart_enabled, T primitive_restart_index)
+std::tuple<T, T> expand_indexed_triangle_fan(gsl::span<to_be_t<const T>> src, gsl::span<T> dst, bool is_primitive_restart_enabled, u32 primitive_restart_index)
 {
-	T min_index = -1;
-	T max_index = 0;
+	static const index_expand_masks<T> masks;
 
-	verify(HERE), (4 * dst.size_bytes() >= 6 * src.size_bytes());
+	index_processor<T> indices(is_primitive_restart_enabled, primitive_restart_index);
+
+	const u32 count = ::narrow<u32>(src.size());
 
-	size_t dst_idx = 0;
-	while (!src.empty())
+	if (count < 3)
 	{
-		gsl::span<to_be_t<const T>> quad_indexes = src.subspan(0, 4);
-		T index0 = quad_indexes[0];
-		if (is_primitive_restart_enabled && index0 == primitive_restart_index)
-		{
-			index0 = -1;
-		}
-		else
-		{
-			min_index = std::min(min_index, index0);
-			max_index = std::max(max_index, index0);
-		}
-		T index1 = quad_indexes[1];
-		if (is_primitive_restart_enabled && index1 == primitive_restart_index)
-		{
-			index1 = -1;
-		}
-		else
-		{
-			min_index = std::min(min_index, index1);
-			max_index = std::max(max_index, index1);
-		}
-		T index2 = quad_indexes[2];
-		if (is_primitive_restart_enabled && index2 == primitive_restart_index)
-		{
-			index2 = -1;
-		}
-		else
-		{
-			min_index = std::min(min_index, index2);
-			max_index = std::max(max_index, index2);
-		}
-		T index3 = quad_indexes[3];
-		if (is_primitive_restart_enabled &&index3 == primitive_restart_index)
-		{
-			index3 = -1;
-		}
-		else
+		return indices.result();
+	}
+
+	verify(HERE), (dst.size() >= 3 * (count - 2));
+
+	const auto src_data = src.data();
+	const auto dst_data = dst.data();
+
+	const T index0 = indices.process(src_data[0]);
+	const __m128i index0_v = sizeof(T) == 2 ? _mm_set1_epi16(index0) : _mm_set1_epi32(index0);
+
+	// Triangle (index0, src[k], src[k + 1]) for k in [1, count - 1)
+	u32 k = 1;
+	u32 dst_idx = 0;
+
+	for (; k + 16 / sizeof(T) < count; k += 16 / sizeof(T), dst_idx += 3 * 16 / sizeof(T))
+	{
+		const __m128i a = indices.process(src_data + k);
+		const __m128i b = indices.process(src_data + k + 1);
+
+		for (u32 j = 0; j < 3; j++)
 		{
-			min_index = std::min(min_index, index3);
-			max_index = std::max(max_index, index3);
+			const __m128i ab = _mm_or_si128(_mm_shuffle_epi8(a, masks.fan_a[j]), _mm_shuffle_epi8(b, masks.fan_b[j]));
+			_mm_storeu_si128((__m128i*)(dst_data + dst_idx) + j, _mm_or_si128(ab, _mm_and_si128(index0_v, masks.fan_0[j])));
 		}
+	}
+
+	for (; k + 1 < count; k++)
+	{
+		dst_data[dst_idx++] = index0;
+		dst_data[dst_idx++] = indices.process(src_data[k]);
+		dst_data[dst_idx++] = indices.process(src_data[k + 1]);
+	}
+
+	return indices.result();
+}
+
+// FIXME: expanded primitive type may not support primitive restart correctly
+template<typename T>
+std::tuple<T, T> expand_indexed_quads(gsl::span<to_be_t<const T>> src, gsl::span<T> dst, bool is_primitive_restart_enabled, u32 primitive_restart_index)
+{
+	static const index_expand_masks<T> masks;
+
+	index_processor<T> indices(is_primitive_restart_enabled, primitive_restart_index);
+
+	verify(HERE), (4 * dst.size_bytes() >= 6 * src.size_bytes());
+
+	const u32 count = ::narrow<u32>(src.size());
+	const auto src_data = src.data();
+	const auto dst_data = dst.data();
+
+	u32 i = 0;
+	u32 dst_idx = 0;
+
+	for (; i + 16 / sizeof(T) <= count; i += 16 / sizeof(T), dst_idx += 6 * 16 / sizeof(T) / 4)
+	{
+		const __m128i value = indices.process(src_data + i);
+		_mm_storeu_si128((__m128i*)(dst_data + dst_idx), _mm_shuffle_epi8(value, masks.quad[0]));
+		_mm_storel_epi64((__m128i*)(dst_data + dst_idx) + 1, _mm_shuffle_epi8(value, masks.quad[1]));
+	}
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const T index0 = indices.process(src_data[i]);
+		const T index1 = indices.process(src_data[i + 1]);
+		const T index2 = indices.process(src_data[i + 2]);
+		const T index3 = indices.process(src_data[i + 3]);
 
 		// First triangle
-		dst[dst_idx++] = index0;
-		dst[dst_idx++] = index1;
-		dst[dst_idx++] = index2;
+		dst_data[dst_idx++] = index0;
+		dst_data[dst_idx++] = index1;
+		dst_data[dst_idx++] = index2;
 		// Second triangle
-		dst[dst_idx++] = index2;
-		dst[dst_idx++] = index3;
-		dst[dst_idx++] = index0;
-
-		src = src.subspan(4);
+		dst_data[dst_idx++] = index2;
+		dst_data[dst_idx++] = index3;
+		dst_data[dst_idx++] = index0;
 	}
-	return std::make_tuple(min_index, max_index);
+
+	return indices.result();
 }
 }
 
@@ -12,6 +12,17 @@
  */
 void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::span<const gsl::byte> src_ptr, u32 count, rsx::vertex_base_type type, u32 vector_element_count, u32 attribute_src_stride, u8 dst_stride);
 
+/**
+ * Returns the upload cache key of count vertex attributes converted with write_vertex_array_data_to_buffer.
+ */
+rsx::upload_cache::key_t get_vertex_array_cache_key(const rsx::vertex_array_buffer& vertex_array, u32 count, u8 dst_stride);
+
+/**
+ * Returns the upload cache key of an index array converted with write_index_array_data_to_buffer.
+ */
+rsx::upload_cache::key_t get_index_array_cache_key(gsl::span<const gsl::byte> src, u32 dst_size, rsx::index_array_type type, rsx::primitive_type draw_mode,
+	bool restart_index_enabled, u32 restart_index, const std::vector<std::pair<u32, u32> > &first_count_arguments);
+
 /*
  * If primitive mode is not supported and need to be emulated (using an index buffer) returns false.
  */
@@ -0,0 +1,211 @@
+#include "stdafx.h"
+#include "Utilities/Config.h"
+#include "Emu/Memory/Memory.h"
+#include "upload_cache.h"
+
+cfg::int_entry<0, 1024> g_cfg_rsx_upload_cache_size(cfg::root.video, "Vertex upload cache size (MB)", 64);
+
+namespace rsx
+{
+	namespace
+	{
+		// Page range of the key's source data
+		std::pair<u32, u32> get_page_range(const upload_cache::key_t& key)
+		{
+			const u32 start = key.address / 4096;
+			const u32 end = static_cast<u32>((u64{key.address} + key.size + 4095) / 4096);
+			return{ start, end };
+		}
+	}
+
+	bool upload_cache::find(const key_t& key, gsl::span<gsl::byte> dst, u64& result)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		const auto found = m_entries.find(key);
+
+		if (found == m_entries.end())
+		{
+			return false;
+		}
+
+		// The pages may have been unlocked by another cache without a write access
+		const auto pages = get_page_range(key);
+
+		if (!vm::page_check(pages.first * 4096, (pages.second - pages.first) * 4096, 0, vm::page_writable))
+		{
+			m_size -= found->second.data.size();
+			m_entries.erase(found);
+			return false;
+		}
+
+		std::memcpy(dst.data(), found->second.data.data(), found->second.data.size());
+		found->second.last_used = m_frame;
+		result = found->second.result;
+
+		m_stats.hits++;
+		m_stats.hit_bytes += found->second.data.size();
+		return true;
+	}
+
+	bool upload_cache::lock(const key_t& key, u32& invalidations)
+	{
+		const auto pages = get_page_range(key);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			const u64 budget = g_cfg_rsx_upload_cache_size * 0x100000ull;
+
+			if (m_size + key.dst_size > budget)
+			{
+				m_stats.uncached++;
+				return false;
+			}
+
+			// Don't cache data which is likely to be modified again
+			for (u32 page = pages.first; page < pages.second; page++)
+			{
+				const auto found = m_written_pages.find(page);
+
+				if (found != m_written_pages.end() && m_frame - found->second < 2)
+				{
+					m_stats.uncached++;
+					return false;
+				}
+			}
+
+			invalidations = m_invalidations;
+		}
+
+		// Protect the pages before the conversion (not under the lock, a write access may be performed with vm locked)
+		if (!vm::page_protect(pages.first * 4096, (pages.second - pages.first) * 4096, 0, 0, vm::page_writable))
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stats.uncached++;
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		for (u32 page = pages.first; page < pages.second; page++)
+		{
+			m_locked_pages.emplace(page);
+		}
+
+		m_stats.misses++;
+		return true;
+	}
+
+	void upload_cache::insert(const key_t& key, std::vector<u8>&& data, u64 result, u32 invalidations)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// Source data may have been modified during the conversion
+		if (invalidations != m_invalidations)
+		{
+			return;
+		}
+
+		auto& entry = m_entries[key];
+		m_size -= entry.data.size();
+		m_size += data.size();
+		entry.data = std::move(data);
+		entry.result = result;
+		entry.last_used = m_frame;
+	}
+
+	bool upload_cache::on_access_violation(u32 address, bool is_writing)
+	{
+		if (!is_writing)
+		{
+			return false;
+		}
+
+		const u32 page = address / 4096;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (!m_locked_pages.erase(page))
+			{
+				return false;
+			}
+
+			m_written_pages[page] = m_frame;
+			m_invalidations++;
+
+			for (auto it = m_entries.begin(); it != m_entries.end();)
+			{
+				const auto pages = get_page_range(it->first);
+
+				if (page >= pages.first && page < pages.second)
+				{
+					m_size -= it->second.data.size();
+					it = m_entries.erase(it);
+				}
+				else
+				{
+					it++;
+				}
+			}
+		}
+
+		// Other pages of the removed entries stay locked until written
+		vm::page_protect(page * 4096, 4096, 0, vm::page_writable, 0);
+		return true;
+	}
+
+	void upload_cache::on_flip()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		const u64 budget = g_cfg_rsx_upload_cache_size * 0x100000ull;
+
+		// Evict entries not used recently (or not used in the last frame if over budget)
+		for (auto it = m_entries.begin(); it != m_entries.end();)
+		{
+			if (m_frame - it->second.last_used > 120 || (m_size > budget && it->second.last_used != m_frame))
+			{
+				m_size -= it->second.data.size();
+				it = m_entries.erase(it);
+			}
+			else
+			{
+				it++;
+			}
+		}
+
+		for (auto it = m_written_pages.begin(); it != m_written_pages.end();)
+		{
+			if (m_frame - it->second >= 2)
+			{
+				it = m_written_pages.erase(it);
+			}
+			else
+			{
+				it++;
+			}
+		}
+
+		m_frame++;
+		m_last_stats = m_stats;
+		m_stats = {};
+	}
+
+	upload_cache::stats_t upload_cache::get_stats()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_last_stats;
+	}
+
+	void upload_cache::clear()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_entries.clear();
+		m_written_pages.clear();
+		m_size = 0;
+		m_invalidations++;
+	}
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <vector>
+
+#include "Utilities/GSL.h"
+
+namespace rsx
+{
+	/**
+	 * Cache of converted vertex and index data, keyed by guest memory range and conversion parameters.
+	 * Source pages are write-protected (like in the texture caches), a write access invalidates all entries on the page.
+	 * Ranges written recently are not cached to avoid protection faults on dynamic geometry.
+	 */
+	class upload_cache
+	{
+	public:
+		struct key_t
+		{
+			u32 address; // Source range
+			u32 size;
+			u32 dst_size; // Converted data size
+			u32 params[3]; // Conversion parameters (format, stride, etc.)
+
+			bool operator==(const key_t& rhs) const
+			{
+				return address == rhs.address && size == rhs.size && dst_size == rhs.dst_size &&
+					params[0] == rhs.params[0] && params[1] == rhs.params[1] && params[2] == rhs.params[2];
+			}
+		};
+
+		struct stats_t
+		{
+			u32 hits = 0;
+			u32 misses = 0;
+			u32 uncached = 0; // Not cached (recently written, disabled or over budget)
+			u64 hit_bytes = 0;
+		};
+
+	private:
+		struct key_hash
+		{
+			std::size_t operator()(const key_t& key) const
+			{
+				u64 hash = key.address;
+				hash = hash * 0x9e3779b97f4a7c15ull + key.size;
+				hash = hash * 0x9e3779b97f4a7c15ull + key.dst_size;
+				hash = hash * 0x9e3779b97f4a7c15ull + key.params[0];
+				hash = hash * 0x9e3779b97f4a7c15ull + key.params[1];
+				hash = hash * 0x9e3779b97f4a7c15ull + key.params[2];
+				return static_cast<std::size_t>(hash ^ (hash >> 32));
+			}
+		};
+
+		struct entry_t
+		{
+			std::vector<u8> data;
+			u64 result; // Value returned by the conversion (index min/max, etc.)
+			u32 last_used; // Frame
+		};
+
+		std::mutex m_mutex;
+
+		std::unordered_map<key_t, entry_t, key_hash> m_entries;
+		std::unordered_set<u32> m_locked_pages; // Pages write-protected by the cache
+		std::unordered_map<u32, u32> m_written_pages; // Page -> frame of the last write access
+
+		u64 m_size = 0; // Total size of cached data
+		u32 m_frame = 0;
+		u32 m_invalidations = 0;
+
+		stats_t m_stats;
+		stats_t m_last_stats;
+
+		bool find(const key_t& key, gsl::span<gsl::byte> dst, u64& result);
+		bool lock(const key_t& key, u32& invalidations);
+		void insert(const key_t& key, std::vector<u8>&& data, u64 result, u32 invalidations);
+
+	public:
+		/**
+		 * Fill dst with cached data or convert the source range with convert(gsl::span<gsl::byte>) -> u64.
+		 * Returns the conversion result.
+		 */
+		template<typename F>
+		u64 upload(const key_t& key, gsl::span<gsl::byte> dst, F&& convert)
+		{
+			u64 result;
+
+			if (find(key, dst, result))
+			{
+				return result;
+			}
+
+			u32 invalidations;
+
+			if (!lock(key, invalidations))
+			{
+				return convert(dst);
+			}
+
+			// Convert to host memory first, the destination may be write-combined
+			std::vector<u8> data(dst.size_bytes());
+			result = convert(gsl::span<gsl::byte>{ reinterpret_cast<gsl::byte*>(data.data()), ::narrow<int>(data.size()) });
+			std::memcpy(dst.data(), data.data(), data.size());
+
+			insert(key, std::move(data), result, invalidations);
+			return result;
+		}
+
+		// Handle write access to a page protected by the cache
+		bool on_access_violation(u32 address, bool is_writing);
+
+		// Start new frame, evict unused entries
+		void on_flip();
+
+		// Statistics of the last frame
+		stats_t get_stats();
+
+		void clear();
+	};
+}
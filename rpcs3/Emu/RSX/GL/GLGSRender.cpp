@@ -696,44 +696,50 @@ bool GLGSRender::do_method(u32 cmd, u32 arg)
 
 bool GLGSRender::load_program()
 {
-	RSXVertexProgram vertex_program = get_current_vertex_program();
-	RSXFragmentProgram fragment_program = get_current_fragment_program();
+	auto old_program = m_program;
 
-	for (auto &vtx : vertex_program.rsx_vertex_inputs)
+	// Reuse the pipeline of the previous draw if the programs and related state didn't change
+	if (!m_program || shader_programs_dirty())
 	{
-		auto &array_info = rsx::method_registers.vertex_arrays_info[vtx.location];
-		if (array_info.type() == rsx::vertex_base_type::s1 ||
-			array_info.type() == rsx::vertex_base_type::cmp)
+		m_vertex_program = get_current_vertex_program();
+		m_fragment_program = get_current_fragment_program();
+
+		for (auto &vtx : m_vertex_program.rsx_vertex_inputs)
 		{
-			//Some vendors do not support GL_x_SNORM buffer textures
-			verify(HERE), vtx.flags == 0;
-			vtx.flags |= GL_VP_FORCE_ATTRIB_SCALING | GL_VP_ATTRIB_S16_INT;
+			auto &array_info = rsx::method_registers.vertex_arrays_info[vtx.location];
+			if (array_info.type() == rsx::vertex_base_type::s1 ||
+				array_info.type() == rsx::vertex_base_type::cmp)
+			{
+				//Some vendors do not support GL_x_SNORM buffer textures
+				verify(HERE), vtx.flags == 0;
+				vtx.flags |= GL_VP_FORCE_ATTRIB_SCALING | GL_VP_ATTRIB_S16_INT;
+			}
 		}
-	}
 
-	for (int i = 0; i < 16; ++i)
-	{
-		auto &tex = rsx::method_registers.fragment_textures[i];
-		if (tex.enabled())
+		for (int i = 0; i < 16; ++i)
 		{
-			const u32 texaddr = rsx::get_address(tex.offset(), tex.location());
-			if (m_rtts.get_texture_from_depth_stencil_if_applicable(texaddr))
+			auto &tex = rsx::method_registers.fragment_textures[i];
+			if (tex.enabled())
 			{
-				//Ignore this rtt since we have an aloasing color texture that will be used
-				if (m_rtts.get_texture_from_render_target_if_applicable(texaddr))
-					continue;
-
-				u32 format = tex.format() & ~(CELL_GCM_TEXTURE_LN | CELL_GCM_TEXTURE_UN);
-				if (format == CELL_GCM_TEXTURE_A8R8G8B8 || format == CELL_GCM_TEXTURE_D8R8G8B8)
+				const u32 texaddr = rsx::get_address(tex.offset(), tex.location());
+				if (m_rtts.get_texture_from_depth_stencil_if_applicable(texaddr))
 				{
-					fragment_program.redirected_textures |= (1 << i);
+					//Ignore this rtt since we have an aloasing color texture that will be used
+					if (m_rtts.get_texture_from_render_target_if_applicable(texaddr))
+						continue;
+
+					u32 format = tex.format() & ~(CELL_GCM_TEXTURE_LN | CELL_GCM_TEXTURE_UN);
+					if (format == CELL_GCM_TEXTURE_A8R8G8B8 || format == CELL_GCM_TEXTURE_D8R8G8B8)
+					{
+						m_fragment_program.redirected_textures |= (1 << i);
+					}
 				}
 			}
 		}
+
+		m_program = &m_prog_buffer.getGraphicPipelineState(m_vertex_program, m_fragment_program, nullptr);
 	}
 
-	auto old_program = m_program;
-	m_program = &m_prog_buffer.getGraphicPipelineState(vertex_program, fragment_program, nullptr);
 	m_program->use();
 
 	if (old_program == m_program && !m_transform_constants_dirty)
@@ -775,7 +781,7 @@ bool GLGSRender::load_program()
 
 	m_transform_constants_dirty = false;
 
-	u32 fragment_constants_size = m_prog_buffer.get_fragment_constants_buffer_size(fragment_program);
+	u32 fragment_constants_size = m_prog_buffer.get_fragment_constants_buffer_size(m_fragment_program);
 	fragment_constants_size = std::max(32U, fragment_constants_size);
 	u32 max_buffer_sz = 512 + 8192 + align(fragment_constants_size, m_uniform_buffer_offset_align);
 
@@ -815,7 +821,7 @@ bool GLGSRender::load_program()
 		mapping = m_uniform_ring_buffer->alloc_from_heap(fragment_constants_size, m_uniform_buffer_offset_align);
 		buf = static_cast<u8*>(mapping.first);
 		fragment_constants_offset = mapping.second;
-		m_prog_buffer.fill_fragment_constants_buffer({ reinterpret_cast<float*>(buf), gsl::narrow<int>(fragment_constants_size) }, fragment_program);
+		m_prog_buffer.fill_fragment_constants_buffer({ reinterpret_cast<float*>(buf), gsl::narrow<int>(fragment_constants_size) }, m_fragment_program);
 	}
 
 	m_uniform_ring_buffer->bind_range(0, scale_offset_offset, 512);
@@ -944,6 +950,9 @@ void GLGSRender::flip(int buffer)
 		m_text_printer.print_text(0, 36, m_frame->client_width(), m_frame->client_height(), "vertex upload time: " + std::to_string(m_vertex_upload_time) + "us");
 		m_text_printer.print_text(0, 54, m_frame->client_width(), m_frame->client_height(), "textures upload time: " + std::to_string(m_textures_upload_time) + "us");
 		m_text_printer.print_text(0, 72, m_frame->client_width(), m_frame->client_height(), "draw call execution: " + std::to_string(m_draw_time) + "us");
+
+		const auto upload_stats = m_upload_cache.get_stats();
+		m_text_printer.print_text(0, 90, m_frame->client_width(), m_frame->client_height(), fmt::format("vertex cache: %u hits (%u KB), %u misses, %u uncached", upload_stats.hits, upload_stats.hit_bytes / 1024, upload_stats.misses, upload_stats.uncached));
 	}
 
 	m_frame->flip(m_context);
@@ -19,7 +19,10 @@ private:
 	rsx::gl::texture m_gl_textures[rsx::limits::fragment_textures_count];
 	rsx::gl::texture m_gl_vertex_textures[rsx::limits::vertex_textures_count];
 
-	gl::glsl::program *m_program;
+	gl::glsl::program *m_program = nullptr;
+
+	RSXVertexProgram m_vertex_program;
+	RSXFragmentProgram m_fragment_program;
 
 	gl_render_targets m_rtts;
 
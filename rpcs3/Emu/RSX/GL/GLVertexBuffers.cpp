@@ -169,7 +169,7 @@ namespace
 		return std::make_tuple(vertex_draw_count, mapping.second);
 	}
 
-	std::tuple<u32, u32, u32> upload_index_buffer(gsl::span<const gsl::byte> raw_index_buffer, void *ptr, rsx::index_array_type type, rsx::primitive_type draw_mode, const std::vector<std::pair<u32, u32>> first_count_commands, u32 initial_vertex_count)
+	std::tuple<u32, u32, u32> upload_index_buffer(rsx::upload_cache& cache, gsl::span<const gsl::byte> raw_index_buffer, void *ptr, rsx::index_array_type type, rsx::primitive_type draw_mode, const std::vector<std::pair<u32, u32>> first_count_commands, u32 initial_vertex_count)
 	{
 		u32 min_index, max_index, vertex_draw_count = initial_vertex_count;
 
@@ -180,9 +180,22 @@ namespace
 		u32 block_sz = vertex_draw_count * type_size;
 
 		gsl::span<gsl::byte> dst{ reinterpret_cast<gsl::byte*>(ptr), ::narrow<u32>(block_sz) };
-		std::tie(min_index, max_index) = write_index_array_data_to_buffer(dst, raw_index_buffer,
-			type, draw_mode, rsx::method_registers.restart_index_enabled(), rsx::method_registers.restart_index(), first_count_commands,
-			[](auto prim) { return !gl::is_primitive_native(prim); });
+
+		const bool restart_index_enabled = rsx::method_registers.restart_index_enabled();
+		const u32 restart_index = rsx::method_registers.restart_index();
+		const auto key = get_index_array_cache_key(raw_index_buffer, block_sz, type, draw_mode, restart_index_enabled, restart_index, first_count_commands);
+
+		const u64 min_max = cache.upload(key, dst, [&](gsl::span<gsl::byte> dst) -> u64
+		{
+			std::tie(min_index, max_index) = write_index_array_data_to_buffer(dst, raw_index_buffer,
+				type, draw_mode, restart_index_enabled, restart_index, first_count_commands,
+				[](auto prim) { return !gl::is_primitive_native(prim); });
+
+			return u64{min_index} << 32 | max_index;
+		});
+
+		min_index = static_cast<u32>(min_max >> 32);
+		max_index = static_cast<u32>(min_max);
 
 		return std::make_tuple(min_index, max_index, vertex_draw_count);
 	}
@@ -203,9 +216,10 @@ namespace
 
 	struct vertex_buffer_visitor
 	{
-		vertex_buffer_visitor(u32 vtx_cnt, gl::ring_buffer& heap, gl::glsl::program* prog, gl::texture* attrib_buffer, u32 min_texbuffer_offset)
+		vertex_buffer_visitor(u32 vtx_cnt, gl::ring_buffer& heap, rsx::upload_cache& cache, gl::glsl::program* prog, gl::texture* attrib_buffer, u32 min_texbuffer_offset)
 		    : vertex_count(vtx_cnt)
 		    , m_attrib_ring_info(heap)
+		    , m_upload_cache(cache)
 		    , m_program(prog)
 		    , m_gl_attrib_buffers(attrib_buffer)
 		    , m_min_texbuffer_alignment(min_texbuffer_offset)
@@ -231,9 +245,13 @@ namespace
 			buffer_offset     = mapping.second;
 			gsl::span<gsl::byte> dest_span(dst, data_size);
 
-			prepare_buffer_for_writing(dst, vertex_array.type, vertex_array.attribute_size, vertex_count);
+			m_upload_cache.upload(get_vertex_array_cache_key(vertex_array, vertex_count, element_size), dest_span, [&](gsl::span<gsl::byte> dst) -> u64
+			{
+				prepare_buffer_for_writing(dst.data(), vertex_array.type, vertex_array.attribute_size, vertex_count);
 
-			write_vertex_array_data_to_buffer(dest_span, vertex_array.data, vertex_count, vertex_array.type, vertex_array.attribute_size, vertex_array.stride, rsx::get_vertex_type_size_on_host(vertex_array.type, vertex_array.attribute_size));
+				write_vertex_array_data_to_buffer(dst, vertex_array.data, vertex_count, vertex_array.type, vertex_array.attribute_size, vertex_array.stride, element_size);
+				return 0;
+			});
 
 			texture.copy_from(m_attrib_ring_info, gl_type, buffer_offset, data_size);
 		}
@@ -273,6 +291,7 @@ namespace
 	protected:
 		u32 vertex_count;
 		gl::ring_buffer& m_attrib_ring_info;
+		rsx::upload_cache& m_upload_cache;
 		gl::glsl::program* m_program;
 		gl::texture* m_gl_attrib_buffers;
 		GLint m_min_texbuffer_alignment;
@@ -283,11 +302,12 @@ namespace
 		using attribute_storage = std::vector<
 		    std::variant<rsx::vertex_array_buffer, rsx::vertex_array_register, rsx::empty_vertex_array>>;
 
-		draw_command_visitor(gl::ring_buffer& index_ring_buffer, gl::ring_buffer& attrib_ring_buffer,
+		draw_command_visitor(gl::ring_buffer& index_ring_buffer, gl::ring_buffer& attrib_ring_buffer, rsx::upload_cache& upload_cache,
 		    gl::texture* gl_attrib_buffers, gl::glsl::program* program, GLint min_texbuffer_alignment,
 		    std::function<attribute_storage(rsx::rsx_state, std::vector<std::pair<u32, u32>>)> gvb)
 		    : m_index_ring_buffer(index_ring_buffer)
 		    , m_attrib_ring_buffer(attrib_ring_buffer)
+		    , m_upload_cache(upload_cache)
 		    , m_gl_attrib_buffers(gl_attrib_buffers)
 		    , m_program(program)
 		    , m_min_texbuffer_alignment(min_texbuffer_alignment)
@@ -347,7 +367,7 @@ namespace
 			u32 offset_in_index_buffer = mapping.second;
 
 			std::tie(min_index, max_index, index_count) = upload_index_buffer(
-			    command.raw_index_buffer, ptr, type, rsx::method_registers.current_draw_clause.primitive,
+			    m_upload_cache, command.raw_index_buffer, ptr, type, rsx::method_registers.current_draw_clause.primitive,
 			    rsx::method_registers.current_draw_clause.first_count_commands, vertex_count);
 			
 			upload_vertex_buffers(0, max_index, max_vertex_attrib_size);
@@ -377,6 +397,7 @@ namespace
 		u32 max_vertex_attrib_size = 0;
 		gl::ring_buffer& m_index_ring_buffer;
 		gl::ring_buffer& m_attrib_ring_buffer;
+		rsx::upload_cache& m_upload_cache;
 		gl::texture* m_gl_attrib_buffers;
 
 		gl::glsl::program* m_program;
@@ -388,7 +409,7 @@ namespace
 		{
 			u32 verts_allocated = max_index - min_index + 1;
 
-			vertex_buffer_visitor visitor(verts_allocated, m_attrib_ring_buffer,
+			vertex_buffer_visitor visitor(verts_allocated, m_attrib_ring_buffer, m_upload_cache,
 			    m_program, m_gl_attrib_buffers, m_min_texbuffer_alignment);
 			const auto& vertex_buffers =
 			    get_vertex_buffers(rsx::method_registers, {{min_index, verts_allocated}});
@@ -461,7 +482,7 @@ namespace
 std::tuple<u32, std::optional<std::tuple<GLenum, u32>>> GLGSRender::set_vertex_buffer()
 {
 	std::chrono::time_point<std::chrono::system_clock> then = std::chrono::system_clock::now();
-	auto result = std::apply_visitor(draw_command_visitor(*m_index_ring_buffer, *m_attrib_ring_buffer,
+	auto result = std::apply_visitor(draw_command_visitor(*m_index_ring_buffer, *m_attrib_ring_buffer, m_upload_cache,
 	                              m_gl_attrib_buffers, m_program, m_min_texbuffer_alignment,
 	                              [this](const auto& state, const auto& list) {
 		                              return this->get_vertex_buffers(state, list);
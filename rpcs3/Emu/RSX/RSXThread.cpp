@@ -3,11 +3,13 @@
 #include "Emu/Memory/Memory.h"
 #include "Emu/System.h"
 #include "Emu/IdManager.h"
+#include "Emu/Benchmark.h"
 #include "RSXThread.h"
 
 #include "Emu/Cell/PPUCallback.h"
 
 #include "Common/BufferUtils.h"
+#include "Common/ProgramStateCache.h"
 #include "rsx_methods.h"
 
 #include "Utilities/GSL.h"
@@ -28,6 +30,7 @@ cfg::bool_entry g_cfg_rsx_vsync(cfg::root.video, "VSync");
 cfg::bool_entry g_cfg_rsx_debug_output(cfg::root.video, "Debug output");
 cfg::bool_entry g_cfg_rsx_overlay(cfg::root.video, "Debug overlay");
 cfg::bool_entry g_cfg_rsx_gl_legacy_buffers(cfg::root.video, "Use Legacy OpenGL Buffers (Debug)");
+cfg::bool_entry g_cfg_rsx_debugger_capture(cfg::root.video, "Debugger frame capture");
 
 bool user_asked_for_frame_capture = false;
 rsx::frame_capture_data frame_debug;
@@ -290,11 +293,27 @@ namespace rsx
 	{
 		g_access_violation_handler = [this](u32 address, bool is_writing)
 		{
-			return on_access_violation(address, is_writing);
+			// Both caches may have locked the page
+			const bool upload_cache_result = m_upload_cache.on_access_violation(address, is_writing);
+			const bool texture_cache_result = on_access_violation(address, is_writing);
+
+			if (upload_cache_result)
+			{
+				if (UNLIKELY(g_perf_counters.enabled)) g_perf_counters.fault_rsx_upload++;
+			}
+
+			if (texture_cache_result)
+			{
+				if (UNLIKELY(g_perf_counters.enabled)) g_perf_counters.fault_rsx_texture++;
+			}
+
+			return texture_cache_result || upload_cache_result;
 		};
 		m_rtts_dirty = true;
 		memset(m_textures_dirty, -1, sizeof(m_textures_dirty));
 		m_transform_constants_dirty = true;
+		m_vertex_program_dirty = true;
+		m_fragment_program_dirty = true;
 	}
 
 	thread::~thread()
@@ -304,6 +323,12 @@ namespace rsx
 
 	void thread::capture_frame(const std::string &name)
 	{
+		// Only used by the debugger, very slow (the frame capture file doesn't need it)
+		if (!g_cfg_rsx_debugger_capture)
+		{
+			return;
+		}
+
 		frame_capture_data::draw_state draw_state = {};
 
 		int clip_w = rsx::method_registers.surface_clip_width();
@@ -345,6 +370,7 @@ namespace rsx
 		{
 			u32 element_count = rsx::method_registers.current_draw_clause.get_elements_count();
 			capture_frame("Draw " + rsx::to_string(rsx::method_registers.current_draw_clause.primitive) + std::to_string(element_count));
+			m_frame_recorder.record_draw(*this);
 		}
 	}
 
@@ -387,6 +413,20 @@ namespace rsx
 			}
 		});
 
+		// Replay the frame capture repeatedly
+		while (m_replay)
+		{
+			CHECK_EMU_STATUS;
+
+			if (!Emu.IsRunning())
+			{
+				do_internal_task();
+				continue;
+			}
+
+			m_replay->replay(*this);
+		}
+
 		// TODO: exit condition
 		while (true)
 		{
@@ -461,6 +501,7 @@ namespace rsx
 				if (capture_current_frame)
 				{
 					frame_debug.command_queue.push_back(std::make_pair(reg, value));
+					m_frame_recorder.record_method(reg, value);
 				}
 
 				if (auto method = methods[reg])
@@ -470,6 +511,7 @@ namespace rsx
 			}
 
 			ctrl->get = get + (count + 1) * 4;
+			if (UNLIKELY(g_perf_counters.enabled)) g_perf_counters.rsx_methods += count;
 		}
 	}
 
@@ -764,23 +806,39 @@ namespace rsx
 		return rsx::get_address(offset_zeta, m_context_dma_z);
 	}
 
-	RSXVertexProgram thread::get_current_vertex_program() const
+	bool thread::shader_programs_dirty() const
 	{
-		RSXVertexProgram result = {};
-		u32 transform_program_start = rsx::method_registers.transform_program_start();
-		result.data.reserve((512 - transform_program_start) * 4);
+		if (m_vertex_program_dirty || m_fragment_program_dirty)
+		{
+			return true;
+		}
 
-		for (int i = transform_program_start; i < 512; ++i)
+		return std::memcmp(current_fragment_program.addr, current_fragment_ucode.data(), current_fragment_ucode.size()) != 0;
+	}
+
+	const RSXVertexProgram& thread::get_current_vertex_program()
+	{
+		if (!m_vertex_program_dirty)
 		{
-			result.data.resize((i - transform_program_start) * 4 + 4);
-			memcpy(result.data.data() + (i - transform_program_start) * 4, rsx::method_registers.transform_program.data() + i * 4, 4 * sizeof(u32));
+			return current_vertex_program;
+		}
+
+		m_vertex_program_dirty = false;
 
+		RSXVertexProgram& result = current_vertex_program;
+		u32 transform_program_start = rsx::method_registers.transform_program_start();
+		u32 transform_program_end = transform_program_start;
+
+		while (transform_program_end < 512)
+		{
 			D3 d3;
-			d3.HEX = rsx::method_registers.transform_program[i * 4 + 3];
+			d3.HEX = rsx::method_registers.transform_program[transform_program_end++ * 4 + 3];
 
 			if (d3.end)
 				break;
 		}
+
+		result.data.assign(rsx::method_registers.transform_program.data() + transform_program_start * 4, rsx::method_registers.transform_program.data() + transform_program_end * 4);
 		result.output_mask = rsx::method_registers.vertex_attrib_output_mask();
 
 		u32 input_mask = rsx::method_registers.vertex_attrib_input_mask();
@@ -817,9 +875,17 @@ namespace rsx
 	}
 
 
-	RSXFragmentProgram thread::get_current_fragment_program() const
+	const RSXFragmentProgram& thread::get_current_fragment_program()
 	{
-		RSXFragmentProgram result = {};
+		if (!m_fragment_program_dirty && std::memcmp(current_fragment_program.addr, current_fragment_ucode.data(), current_fragment_ucode.size()) == 0)
+		{
+			return current_fragment_program;
+		}
+
+		m_fragment_program_dirty = false;
+
+		RSXFragmentProgram& result = current_fragment_program;
+		result = {};
 		u32 shader_program = rsx::method_registers.shader_program_address();
 		result.offset = shader_program & ~0x3;
 		result.addr = vm::base(rsx::get_address(result.offset, (shader_program & 0x3) - 1));
@@ -860,6 +926,9 @@ namespace rsx
 		}
 		result.set_texture_dimension(texture_dimensions);
 
+		const u8* ucode = static_cast<const u8*>(result.addr);
+		current_fragment_ucode.assign(ucode, ucode + program_hash_util::fragment_program_utils::get_fragment_program_ucode_size(result.addr));
+
 		return result;
 	}
 
@@ -6,11 +6,13 @@
 #include <mutex>
 #include "GCM.h"
 #include "rsx_cache.h"
+#include "Common/upload_cache.h"
 #include "RSXTexture.h"
 #include "RSXVertexProgram.h"
 #include "RSXFragmentProgram.h"
 #include "rsx_methods.h"
 #include "rsx_trace.h"
+#include "rsx_capture.h"
 #include <Utilities/GSL.h>
 
 #include "Utilities/Thread.h"
@@ -168,11 +170,18 @@ namespace rsx
 
 	protected:
 		std::stack<u32> m_call_stack;
+		rsx::upload_cache m_upload_cache;
 
 	public:
 		old_shaders_cache::shaders_cache shaders_cache;
 		rsx::programs_cache programs_cache;
 
+		// Vertex and index upload cache (also used by the flip handler)
+		rsx::upload_cache& get_upload_cache()
+		{
+			return m_upload_cache;
+		}
+
 		CellGcmControl* ctrl = nullptr;
 
 		Timer timer_sync;
@@ -186,6 +195,9 @@ namespace rsx
 		bool capture_current_frame = false;
 		void capture_frame(const std::string &name);
 
+		frame_capture_recorder m_frame_recorder;
+		std::shared_ptr<frame_capture> m_replay; // Frame capture replayed instead of the FIFO
+
 	public:
 		std::shared_ptr<class ppu_thread> intr_thread;
 
@@ -209,11 +221,27 @@ namespace rsx
 		bool m_rtts_dirty;
 		bool m_transform_constants_dirty;
 		bool m_textures_dirty[16];
+		bool m_vertex_program_dirty;
+		bool m_fragment_program_dirty;
 	protected:
+		RSXVertexProgram current_vertex_program = {};
+		RSXFragmentProgram current_fragment_program;
+		std::vector<u8> current_fragment_ucode; // Fragment program ucode copy (it can be modified in memory without register writes)
+
 		std::array<u32, 4> get_color_surface_addresses() const;
 		u32 get_zeta_surface_address() const;
-		RSXVertexProgram get_current_vertex_program() const;
-		RSXFragmentProgram get_current_fragment_program() const;
+
+		/**
+		* Returns true if the registers used to build the shader programs or the fragment program ucode were modified
+		* since the last get_current_vertex_program()/get_current_fragment_program() call.
+		*/
+		bool shader_programs_dirty() const;
+
+		/**
+		* Current programs, only rebuilt from the registers when they are dirty.
+		*/
+		const RSXVertexProgram& get_current_vertex_program();
+		const RSXFragmentProgram& get_current_fragment_program();
 	public:
 		double fps_limit = 59.94;
 
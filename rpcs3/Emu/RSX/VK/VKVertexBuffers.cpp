@@ -249,10 +249,10 @@ namespace
 
 	struct vertex_buffer_visitor
 	{
-		vertex_buffer_visitor(u32 vtx_cnt, VkDevice dev, vk::vk_data_heap& heap,
+		vertex_buffer_visitor(u32 vtx_cnt, VkDevice dev, vk::vk_data_heap& heap, rsx::upload_cache& cache,
 			vk::glsl::program* prog, VkDescriptorSet desc_set,
 			std::vector<std::unique_ptr<vk::buffer_view>>& buffer_view_to_clean)
-			: vertex_count(vtx_cnt), m_attrib_ring_info(heap), device(dev), m_program(prog),
+			: vertex_count(vtx_cnt), m_attrib_ring_info(heap), m_upload_cache(cache), device(dev), m_program(prog),
 			  descriptor_sets(desc_set), m_buffer_view_to_clean(buffer_view_to_clean)
 		{
 		}
@@ -269,10 +269,15 @@ namespace
 
 			VkDeviceSize offset_in_attrib_buffer = m_attrib_ring_info.alloc<256>(upload_size);
 			void *dst = m_attrib_ring_info.map(offset_in_attrib_buffer, upload_size);
-			vk::prepare_buffer_for_writing(dst, vertex_array.type, vertex_array.attribute_size, vertex_count);
 			gsl::span<gsl::byte> dest_span(static_cast<gsl::byte*>(dst), upload_size);
 
-			write_vertex_array_data_to_buffer(dest_span, vertex_array.data, vertex_count, vertex_array.type, vertex_array.attribute_size, vertex_array.stride, real_element_size);
+			m_upload_cache.upload(get_vertex_array_cache_key(vertex_array, vertex_count, real_element_size), dest_span, [&](gsl::span<gsl::byte> dst) -> u64
+			{
+				vk::prepare_buffer_for_writing(dst.data(), vertex_array.type, vertex_array.attribute_size, vertex_count);
+
+				write_vertex_array_data_to_buffer(dst, vertex_array.data, vertex_count, vertex_array.type, vertex_array.attribute_size, vertex_array.stride, real_element_size);
+				return 0;
+			});
 
 			m_attrib_ring_info.unmap();
 			const VkFormat format = vk::get_suitable_vk_format(vertex_array.type, vertex_array.attribute_size);
@@ -337,6 +342,7 @@ namespace
 		VkDevice device;
 		u32 vertex_count;
 		vk::vk_data_heap& m_attrib_ring_info;
+		rsx::upload_cache& m_upload_cache;
 		vk::glsl::program* m_program;
 		VkDescriptorSet descriptor_sets;
 		std::vector<std::unique_ptr<vk::buffer_view>>& m_buffer_view_to_clean;
@@ -351,14 +357,14 @@ namespace
 			std::optional<std::tuple<VkDeviceSize, VkIndexType>>>;
 
 		draw_command_visitor(VkDevice device, vk::vk_data_heap& index_buffer_ring_info,
-			vk::vk_data_heap& attrib_ring_info, vk::glsl::program* program,
+			vk::vk_data_heap& attrib_ring_info, rsx::upload_cache& upload_cache, vk::glsl::program* program,
 			VkDescriptorSet descriptor_sets,
 			std::vector<std::unique_ptr<vk::buffer_view>>& buffer_view_to_clean,
 			std::function<attribute_storage(
 				const rsx::rsx_state&, const std::vector<std::pair<u32, u32>>&)>
 				get_vertex_buffers_f)
 			: m_device(device), m_index_buffer_ring_info(index_buffer_ring_info),
-			  m_attrib_ring_info(attrib_ring_info), m_program(program),
+			  m_attrib_ring_info(attrib_ring_info), m_upload_cache(upload_cache), m_program(program),
 			  m_descriptor_sets(descriptor_sets), m_buffer_view_to_clean(buffer_view_to_clean),
 			  get_vertex_buffers(get_vertex_buffers_f)
 		{
@@ -411,14 +417,26 @@ namespace
 			/**
 			* Upload index (and expands it if primitive type is not natively supported).
 			*/
-			u32 min_index, max_index;
-			std::tie(min_index, max_index) = write_index_array_data_to_buffer(
-				gsl::span<gsl::byte>(static_cast<gsl::byte*>(buf), index_count * type_size),
-				command.raw_index_buffer, index_type,
-				rsx::method_registers.current_draw_clause.primitive,
-				rsx::method_registers.restart_index_enabled(),
-				rsx::method_registers.restart_index(), command.ranges_to_fetch_in_index_buffer,
-				[](auto prim) { return !vk::is_primitive_native(prim); });
+			const gsl::span<gsl::byte> dst(static_cast<gsl::byte*>(buf), index_count * type_size);
+			const rsx::primitive_type primitive = rsx::method_registers.current_draw_clause.primitive;
+			const bool restart_index_enabled = rsx::method_registers.restart_index_enabled();
+			const u32 restart_index = rsx::method_registers.restart_index();
+
+			const auto key = get_index_array_cache_key(command.raw_index_buffer, upload_size, index_type, primitive,
+				restart_index_enabled, restart_index, command.ranges_to_fetch_in_index_buffer);
+
+			const u64 min_max = m_upload_cache.upload(key, dst, [&](gsl::span<gsl::byte> dst) -> u64
+			{
+				u32 min_index, max_index;
+				std::tie(min_index, max_index) = write_index_array_data_to_buffer(
+					dst, command.raw_index_buffer, index_type, primitive,
+					restart_index_enabled, restart_index, command.ranges_to_fetch_in_index_buffer,
+					[](auto prim) { return !vk::is_primitive_native(prim); });
+
+				return u64{min_index} << 32 | max_index;
+			});
+
+			const u32 max_index = static_cast<u32>(min_max);
 
 			m_index_buffer_ring_info.unmap();
 
@@ -450,6 +468,7 @@ namespace
 		vk::vk_data_heap& m_index_buffer_ring_info;
 		VkDevice m_device;
 		vk::vk_data_heap& m_attrib_ring_info;
+		rsx::upload_cache& m_upload_cache;
 		vk::glsl::program* m_program;
 		VkDescriptorSet m_descriptor_sets;
 		std::vector<std::unique_ptr<vk::buffer_view>>& m_buffer_view_to_clean;
@@ -460,7 +479,7 @@ namespace
 		void upload_vertex_buffers(u32 min_index, u32 vertex_max_index)
 		{
 			vertex_buffer_visitor visitor(vertex_max_index - min_index + 1, m_device,
-				m_attrib_ring_info, m_program, m_descriptor_sets, m_buffer_view_to_clean);
+				m_attrib_ring_info, m_upload_cache, m_program, m_descriptor_sets, m_buffer_view_to_clean);
 			const auto& vertex_buffers = get_vertex_buffers(
 				rsx::method_registers, {{min_index, vertex_max_index - min_index + 1}});
 			for (const auto& vbo : vertex_buffers) std::apply_visitor(visitor, vbo);
@@ -555,7 +574,7 @@ namespace
 std::tuple<VkPrimitiveTopology, u32, std::optional<std::tuple<VkDeviceSize, VkIndexType>>>
 VKGSRender::upload_vertex_data()
 {
-	draw_command_visitor visitor(*m_device, m_index_buffer_ring_info, m_attrib_ring_info, m_program,
+	draw_command_visitor visitor(*m_device, m_index_buffer_ring_info, m_attrib_ring_info, m_upload_cache, m_program,
 		descriptor_sets, m_buffer_view_to_clean,
 		[this](const auto& state, const auto& range) { return get_vertex_buffers(state, range); });
 	return std::apply_visitor(visitor, get_draw_command(rsx::method_registers));
@@ -0,0 +1,570 @@
+#include "stdafx.h"
+#include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
+#include "Emu/IdManager.h"
+#include "Emu/Benchmark.h"
+#include "GSRender.h"
+#include "rsx_capture.h"
+
+#include "Common/BufferUtils.h"
+#include "Common/TextureUtils.h"
+#include "Common/ProgramStateCache.h"
+
+#include <sstream>
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/utility.hpp>
+#include <cereal/types/vector.hpp>
+#include <zlib.h>
+
+namespace vm { using namespace ps3; }
+
+namespace rsx
+{
+	namespace
+	{
+		u64 hash_page(const u8* data)
+		{
+			u64 hash = 0xcbf29ce484222325ull;
+
+			for (u32 i = 0; i < 4096; i += 8)
+			{
+				u64 value;
+				std::memcpy(&value, data + i, sizeof(u64));
+				hash = (hash ^ value) * 0x100000001b3ull;
+			}
+
+			return hash ^ (hash >> 29);
+		}
+
+		// Range of the indices used by the draw call
+		template<typename T>
+		std::pair<u32, u32> get_index_range(gsl::span<const gsl::byte> raw, bool restart_enabled, u32 restart_index)
+		{
+			const auto ptr = reinterpret_cast<const be_t<T>*>(raw.data());
+			const u32 count = ::narrow<u32>(raw.size_bytes()) / sizeof(T);
+
+			// Only the low bits are compared for 16-bit indices
+			const T restart = static_cast<T>(restart_index);
+
+			u32 min_index = -1, max_index = 0;
+
+			for (u32 i = 0; i < count; i++)
+			{
+				const T index = ptr[i];
+
+				if (restart_enabled && index == restart)
+				{
+					continue;
+				}
+
+				min_index = std::min<u32>(min_index, index);
+				max_index = std::max<u32>(max_index, index);
+			}
+
+			return{ min_index, max_index };
+		}
+	}
+
+	bool frame_capture::save(const std::string& path) const
+	{
+		std::stringstream os;
+		{
+			cereal::BinaryOutputArchive archive(os);
+			archive(*this);
+		}
+
+		const std::string data = os.str();
+
+		uLongf size = compressBound(static_cast<uLong>(data.size()));
+		std::vector<u8> compressed(size);
+
+		if (compress2(compressed.data(), &size, reinterpret_cast<const Bytef*>(data.data()), static_cast<uLong>(data.size()), Z_DEFAULT_COMPRESSION) != Z_OK)
+		{
+			return false;
+		}
+
+		fs::file file(path, fs::rewrite);
+
+		if (!file)
+		{
+			return false;
+		}
+
+		file.write(file_magic);
+		file.write(file_version);
+		file.write<u64>(data.size());
+		file.write(compressed.data(), size);
+		return true;
+	}
+
+	std::shared_ptr<frame_capture> frame_capture::load(const fs::file& file)
+	{
+		u32 magic, version;
+		u64 size;
+
+		if (!file || file.size() < 16 || (file.seek(0), !file.read(magic)) || magic != file_magic)
+		{
+			return nullptr;
+		}
+
+		if (!file.read(version) || version != file_version || !file.read(size))
+		{
+			LOG_ERROR(RSX, "Unsupported frame capture version (%u)", version);
+			return nullptr;
+		}
+
+		std::vector<u8> compressed;
+
+		// zlib can't compress more than 1032:1
+		if (!file.read(compressed, file.size() - 16) || size > compressed.size() * 1032 || size > UINT32_MAX)
+		{
+			LOG_ERROR(RSX, "Invalid frame capture size (0x%llx, file size: 0x%llx)", size, file.size());
+			return nullptr;
+		}
+
+		std::string data(size, '\0');
+		uLongf data_size = static_cast<uLongf>(size);
+
+		if (uncompress(reinterpret_cast<Bytef*>(&data[0]), &data_size, compressed.data(), static_cast<uLong>(compressed.size())) != Z_OK || data_size != size)
+		{
+			LOG_ERROR(RSX, "Failed to decompress the frame capture");
+			return nullptr;
+		}
+
+		auto result = std::make_shared<frame_capture>();
+
+		try
+		{
+			std::istringstream is(data);
+			cereal::BinaryInputArchive archive(is);
+			archive(*result);
+		}
+		catch (const std::exception& e)
+		{
+			LOG_ERROR(RSX, "Failed to read the frame capture: %s", e.what());
+			return nullptr;
+		}
+
+		return result;
+	}
+
+	void frame_capture::start_replay(const std::shared_ptr<frame_capture>& capture)
+	{
+		// Local memory (same layout as cellGcmInit)
+		vm::falloc(0xC0000000, 0xf900000, vm::video);
+
+		// Memory blocks not created by the emulator (the pages are allocated below)
+		for (const auto& block : capture->blocks)
+		{
+			if (!vm::get(vm::any, block.addr) && !vm::map(block.addr, block.size))
+			{
+				LOG_ERROR(RSX, "Failed to map the memory block 0x%x (size=0x%x)", block.addr, block.size);
+			}
+		}
+
+		for (const auto& write : capture->memory)
+		{
+			for (const auto& page : write.pages)
+			{
+				if (!vm::check_addr(page.addr, 4096))
+				{
+					vm::falloc(page.addr, 4096);
+				}
+			}
+		}
+
+		RSXIOMem.SetRange(0, 0x20000000 /*512MB*/);
+
+		for (const auto& mapping : capture->io_map)
+		{
+			RSXIOMem.Map(mapping.ea, mapping.size, mapping.io);
+		}
+
+		const auto render = fxm::import<GSRender>(Emu.GetCallbacks().get_gs_render);
+
+		render->gcm_buffers.set(vm::alloc(sizeof(CellGcmDisplayInfo) * 8, vm::main));
+		render->gcm_buffers_count = capture->display_buffers_count;
+		render->gcm_current_buffer = 0;
+
+		for (u32 i = 0; i < 8; i++)
+		{
+			render->gcm_buffers[i].offset = capture->display_buffers[i][0];
+			render->gcm_buffers[i].pitch = capture->display_buffers[i][1];
+			render->gcm_buffers[i].width = capture->display_buffers[i][2];
+			render->gcm_buffers[i].height = capture->display_buffers[i][3];
+		}
+
+		for (u32 i = 0; i < capture->tiles.size() && i < limits::tiles_count; i++)
+		{
+			const auto& src = capture->tiles[i];
+			auto& tile = render->tiles[i];
+			tile.location = src[0];
+			tile.offset = src[1];
+			tile.size = src[2];
+			tile.pitch = src[3];
+			tile.comp = src[4];
+			tile.base = src[5];
+			tile.bank = src[6];
+			tile.binded = src[7] != 0;
+		}
+
+		render->main_mem_addr = 0;
+		render->label_addr = vm::alloc(0x1000, vm::main);
+		render->m_replay = capture;
+		render->init(0, 0, vm::alloc(sizeof(CellGcmControl), vm::main), 0xC0000000);
+
+		LOG_NOTICE(RSX, "Frame capture loaded: %u methods, %u memory pages", capture->method_count, capture->page_data.size());
+	}
+
+	void frame_capture::replay(thread& rsx) const
+	{
+		// Restore the state at the beginning of the frame
+		method_registers = state;
+
+		for (u32 i = 0; i < 16; i++)
+		{
+			auto& info = method_registers.register_vertex_info[i];
+			info.frequency = vertex_registers[i][0];
+			info.stride = vertex_registers[i][1];
+			info.size = vertex_registers[i][2];
+			info.type = static_cast<vertex_base_type>(vertex_registers[i][3]);
+			std::copy(vertex_registers[i].begin() + 4, vertex_registers[i].end(), info.data.begin());
+		}
+
+		rsx.local_transform_constants.clear();
+
+		for (const auto& constant : transform_constants)
+		{
+			rsx.local_transform_constants[constant.first] = color4f(constant.second[0], constant.second[1], constant.second[2], constant.second[3]);
+		}
+
+		rsx.m_rtts_dirty = true;
+		memset(rsx.m_textures_dirty, -1, sizeof(rsx.m_textures_dirty));
+		rsx.m_transform_constants_dirty = true;
+		rsx.m_vertex_program_dirty = true;
+		rsx.m_fragment_program_dirty = true;
+
+		auto write = memory.cbegin();
+		u32 method = 0;
+
+		for (u32 pos = 0; pos < packets.size();)
+		{
+			const u32 header = packets[pos++];
+			const u32 first = header & 0x3fff;
+			const u32 count = header >> 16;
+
+			for (u32 i = 0; i < count; i++, method++)
+			{
+				// Only write modified pages, writing to pages protected by the caches invalidates them
+				for (; write != memory.cend() && write->method == method; write++)
+				{
+					for (const auto& page : write->pages)
+					{
+						const auto& data = page_data[page.data];
+						const auto dst = vm::base(page.addr);
+
+						if (std::memcmp(dst, data.data(), 4096) != 0)
+						{
+							std::memcpy(dst, data.data(), 4096);
+						}
+					}
+				}
+
+				const u32 reg = header & non_increment ? first : first + i;
+				const u32 value = packets[pos + i];
+
+				method_registers.decode(reg, value);
+
+				if (auto func = methods[reg])
+				{
+					func(&rsx, reg, value);
+				}
+			}
+
+			pos += count;
+		}
+
+		if (UNLIKELY(g_perf_counters.enabled)) g_perf_counters.rsx_methods += method_count;
+	}
+
+	void frame_capture_recorder::record_page(u32 addr)
+	{
+		if (!vm::check_addr(addr, 4096))
+		{
+			return;
+		}
+
+		auto& capture = *m_capture;
+		const auto src = vm::_ptr<u8>(addr);
+
+		const auto found = m_pages.find(addr);
+
+		// Record the block containing the page once
+		if (found == m_pages.end())
+		{
+			const auto block = vm::get(vm::any, addr);
+
+			if (block && std::none_of(capture.blocks.begin(), capture.blocks.end(), [&](const frame_capture::memory_block& b) { return b.addr == block->addr; }))
+			{
+				capture.blocks.push_back({ block->addr, block->size });
+			}
+		}
+
+		// Skip pages not modified since they were recorded
+		if (found != m_pages.end() && std::memcmp(capture.page_data[found->second].data(), src, 4096) == 0)
+		{
+			return;
+		}
+
+		const u64 hash = hash_page(src);
+		u32 index = -1;
+
+		for (auto range = m_data.equal_range(hash); range.first != range.second; range.first++)
+		{
+			if (std::memcmp(capture.page_data[range.first->second].data(), src, 4096) == 0)
+			{
+				index = range.first->second;
+				break;
+			}
+		}
+
+		if (index == -1)
+		{
+			index = ::size32(capture.page_data);
+			capture.page_data.emplace_back(src, src + 4096);
+			m_data.emplace(hash, index);
+		}
+
+		m_pages[addr] = index;
+		capture.memory.back().pages.push_back({ addr, index });
+	}
+
+	void frame_capture_recorder::start(thread& rsx)
+	{
+		m_capture = std::make_unique<frame_capture>();
+		m_packet = -1;
+		m_last_method = -1;
+		m_pages.clear();
+		m_data.clear();
+
+		auto& capture = *m_capture;
+
+		capture.title_id = Emu.GetTitleID();
+		capture.state = method_registers;
+
+		for (u32 i = 0; i < 16; i++)
+		{
+			const auto& info = method_registers.register_vertex_info[i];
+			capture.vertex_registers[i] = { info.frequency, info.stride, info.size, static_cast<u32>(info.type), info.data[0], info.data[1], info.data[2], info.data[3] };
+		}
+
+		for (const auto& constant : rsx.local_transform_constants)
+		{
+			capture.transform_constants.emplace_back(constant.first, std::array<f32, 4>{ constant.second.r, constant.second.g, constant.second.b, constant.second.a });
+		}
+
+		for (u32 i = 0; i < 8; i++)
+		{
+			if (rsx.gcm_buffers)
+			{
+				const auto& buffer = rsx.gcm_buffers[i];
+				capture.display_buffers[i] = { buffer.offset, buffer.pitch, buffer.width, buffer.height };
+			}
+			else
+			{
+				capture.display_buffers[i] = {};
+			}
+		}
+
+		capture.display_buffers_count = rsx.gcm_buffers_count;
+
+		for (const auto& tile : rsx.tiles)
+		{
+			capture.tiles.push_back({ tile.location, tile.offset, tile.size, tile.pitch, tile.comp, tile.base, tile.bank, tile.binded });
+		}
+
+		for (const auto& info : RSXIOMem.GetMappedMemory())
+		{
+			capture.io_map.push_back({ info.addr, info.realAddress, info.size });
+		}
+
+		LOG_NOTICE(RSX, "Frame capture started");
+	}
+
+	void frame_capture_recorder::record_method(u32 reg, u32 value)
+	{
+		// Already satisfied when recorded, would block the replay
+		if (reg == NV406E_SEMAPHORE_ACQUIRE)
+		{
+			return;
+		}
+
+		auto& capture = *m_capture;
+		auto& packets = capture.packets;
+
+		capture.method_count++;
+
+		// Append to the current packet if possible
+		if (m_packet < packets.size() && (packets[m_packet] >> 16) < 0xffff && reg == m_last_method + 1 && !(packets[m_packet] & frame_capture::non_increment))
+		{
+			packets[m_packet] += 1 << 16;
+		}
+		else if (m_packet < packets.size() && (packets[m_packet] >> 16) < 0xffff && reg == m_last_method && ((packets[m_packet] >> 16) == 1 || packets[m_packet] & frame_capture::non_increment))
+		{
+			packets[m_packet] = (packets[m_packet] | frame_capture::non_increment) + (1 << 16);
+		}
+		else
+		{
+			m_packet = ::size32(packets);
+			packets.push_back(reg | 1 << 16);
+		}
+
+		packets.push_back(value);
+		m_last_method = reg;
+
+		// Transfer sources (the destination is written by the replay)
+		switch (reg)
+		{
+		case NV0039_BUFFER_NOTIFY:
+		{
+			const u32 line_length = method_registers.nv0039_line_length();
+			const u32 line_count = method_registers.nv0039_line_count();
+			const u32 in_pitch = method_registers.nv0039_input_pitch() ? method_registers.nv0039_input_pitch() : line_length;
+
+			if (line_count)
+			{
+				record_memory(get_address(method_registers.nv0039_input_offset(), method_registers.nv0039_input_location()), in_pitch * (line_count - 1) + line_length);
+			}
+
+			break;
+		}
+		case NV3089_IMAGE_IN:
+		{
+			record_memory(get_address(method_registers.blit_engine_input_offset(), method_registers.blit_engine_input_location()),
+				method_registers.blit_engine_input_pitch() * method_registers.blit_engine_input_height());
+			break;
+		}
+		}
+	}
+
+	void frame_capture_recorder::record_memory(u32 addr, u32 size)
+	{
+		if (!size)
+		{
+			return;
+		}
+
+		auto& capture = *m_capture;
+
+		// Pages are written before the last recorded method
+		const u32 method = capture.method_count ? capture.method_count - 1 : 0;
+
+		if (capture.memory.empty() || capture.memory.back().method != method)
+		{
+			capture.memory.push_back({ method });
+		}
+
+		for (u64 page = addr & ~4095; page < u64{addr} + size; page += 4096)
+		{
+			record_page(static_cast<u32>(page));
+		}
+	}
+
+	void frame_capture_recorder::record_draw(thread& rsx)
+	{
+		const auto& clause = method_registers.current_draw_clause;
+
+		const u32 shader_program = method_registers.shader_program_address();
+		const u32 fp_addr = get_address(shader_program & ~0x3, (shader_program & 0x3) - 1);
+		record_memory(fp_addr, ::narrow<u32>(program_hash_util::fragment_program_utils::get_fragment_program_ucode_size(vm::base(fp_addr))));
+
+		for (const auto& tex : method_registers.fragment_textures)
+		{
+			if (tex.enabled())
+			{
+				record_memory(get_address(tex.offset(), tex.location()), ::narrow<u32>(get_texture_size(tex)));
+			}
+		}
+
+		for (const auto& tex : method_registers.vertex_textures)
+		{
+			if (tex.enabled())
+			{
+				record_memory(get_address(tex.offset(), tex.location()), ::narrow<u32>(get_texture_size(tex)));
+			}
+		}
+
+		std::pair<u32, u32> vertex_range;
+
+		if (clause.command == draw_command::indexed)
+		{
+			const auto indices = rsx.get_raw_index_array(clause.first_count_commands);
+			record_memory(vm::get_addr(indices.data()), ::narrow<u32>(indices.size_bytes()));
+
+			const bool restart_enabled = method_registers.restart_index_enabled();
+			const u32 restart_index = method_registers.restart_index();
+
+			vertex_range = method_registers.index_type() == index_array_type::u16
+				? get_index_range<u16>(indices, restart_enabled, restart_index)
+				: get_index_range<u32>(indices, restart_enabled, restart_index);
+
+			if (vertex_range.first > vertex_range.second)
+			{
+				return;
+			}
+		}
+		else if (clause.command == draw_command::array)
+		{
+			vertex_range = { clause.first_count_commands.front().first, 0 };
+
+			for (const auto& range : clause.first_count_commands)
+			{
+				vertex_range.first = std::min(vertex_range.first, range.first);
+				vertex_range.second = std::max(vertex_range.second, range.first + range.second - 1);
+			}
+		}
+		else
+		{
+			// Inlined arrays are stored in the method stream
+			return;
+		}
+
+		const u32 base_offset = method_registers.vertex_data_base_offset();
+		const u32 input_mask = method_registers.vertex_attrib_input_mask();
+
+		for (u32 index = 0; index < limits::vertex_count; index++)
+		{
+			const auto& info = method_registers.vertex_arrays_info[index];
+
+			if (!(input_mask & (1 << index)) || !info.size())
+			{
+				continue;
+			}
+
+			const u32 offset = info.offset();
+			const u32 address = base_offset + get_address(offset & 0x7fffffff, offset >> 31);
+			const u32 element_size = get_vertex_type_size_on_host(info.type(), info.size());
+
+			record_memory(address + vertex_range.first * info.stride(), (vertex_range.second - vertex_range.first) * info.stride() + element_size);
+		}
+	}
+
+	void frame_capture_recorder::finish(const std::string& path)
+	{
+		const auto& capture = *m_capture;
+
+		if (capture.save(path))
+		{
+			LOG_SUCCESS(RSX, "Frame capture written to %s (%u methods, %u memory pages)", path, capture.method_count, capture.page_data.size());
+		}
+		else
+		{
+			LOG_ERROR(RSX, "Failed to write the frame capture to %s", path);
+		}
+
+		m_capture.reset();
+		m_pages.clear();
+		m_data.clear();
+	}
+}
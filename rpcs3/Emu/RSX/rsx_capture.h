@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Utilities/types.h"
+#include "Utilities/File.h"
+#include "rsx_methods.h"
+
+namespace rsx
+{
+	class thread;
+
+	/**
+	 * Compact frame capture: FIFO method stream of one frame, the state at the beginning of the frame
+	 * and the guest memory pages read by the frame (vertex, index, texture, fragment program, transfer sources).
+	 * Pages are deduplicated by content and only recorded again when modified, the file is compressed with zlib.
+	 */
+	struct frame_capture
+	{
+		static const u32 file_magic = 0x43525852; // "RXRC"
+		static const u32 file_version = 2;
+
+		// Method packet header flag (the method index is 14 bits, count is stored in the upper 16 bits)
+		static const u32 non_increment = 0x8000;
+
+		struct memory_page
+		{
+			u32 addr;
+			u32 data; // Index in page_data
+
+			template<typename Archive>
+			void serialize(Archive& ar)
+			{
+				ar(addr, data);
+			}
+		};
+
+		// Pages written before the method
+		struct memory_write
+		{
+			u32 method; // Index in the method stream (not in the packet stream)
+			std::vector<memory_page> pages;
+
+			template<typename Archive>
+			void serialize(Archive& ar)
+			{
+				ar(method, pages);
+			}
+		};
+
+		// Memory block containing recorded pages (mapped by the replay if missing, like sys_mmapper areas)
+		struct memory_block
+		{
+			u32 addr;
+			u32 size;
+
+			template<typename Archive>
+			void serialize(Archive& ar)
+			{
+				ar(addr, size);
+			}
+		};
+
+		struct io_mapping
+		{
+			u32 io;
+			u32 ea;
+			u32 size;
+
+			template<typename Archive>
+			void serialize(Archive& ar)
+			{
+				ar(io, ea, size);
+			}
+		};
+
+		std::string title_id;
+
+		rsx_state state;
+		std::array<std::array<u32, 8>, 16> vertex_registers; // register_vertex_info (frequency, stride, size, type, data)
+		std::vector<std::pair<u32, std::array<f32, 4>>> transform_constants; // Constants stored for the whole frame
+
+		std::array<std::array<u32, 4>, 8> display_buffers; // offset, pitch, width, height
+		u32 display_buffers_count;
+		std::vector<std::array<u32, 8>> tiles; // location, offset, size, pitch, comp, base, bank, binded
+
+		std::vector<io_mapping> io_map;
+		std::vector<memory_block> blocks;
+
+		std::vector<u32> packets; // Method packets: header (method | flags | count << 16) followed by the values
+		u32 method_count = 0;
+
+		std::vector<memory_write> memory;
+		std::vector<std::vector<u8>> page_data;
+
+		template<typename Archive>
+		void serialize(Archive& ar)
+		{
+			ar(title_id, state, vertex_registers, transform_constants);
+			ar(display_buffers, display_buffers_count, tiles, io_map, blocks);
+			ar(packets, method_count, memory, page_data);
+		}
+
+		// Write the compressed capture
+		bool save(const std::string& path) const;
+
+		// Load the capture, returns nullptr if the file is not a valid capture
+		static std::shared_ptr<frame_capture> load(const fs::file& file);
+
+		// Create the renderer and the guest memory state for the replay (emulator must be initialized)
+		static void start_replay(const std::shared_ptr<frame_capture>& capture);
+
+		// Process the frame on the RSX thread
+		void replay(thread& rsx) const;
+	};
+
+	// Builds the frame_capture while the frame is processed by the RSX thread
+	class frame_capture_recorder
+	{
+		std::unique_ptr<frame_capture> m_capture;
+
+		u32 m_packet = -1; // Current packet header position
+		u32 m_last_method = -1;
+
+		std::unordered_map<u32, u32> m_pages; // Page address -> last recorded data
+		std::unordered_multimap<u64, u32> m_data; // Data hash -> page_data index
+
+		void record_page(u32 addr);
+
+	public:
+		bool is_recording() const
+		{
+			return m_capture != nullptr;
+		}
+
+		// Snapshot the state at the beginning of the frame
+		void start(thread& rsx);
+
+		// Record the method (called before the method is executed)
+		void record_method(u32 reg, u32 value);
+
+		// Record the guest memory range read by the current method
+		void record_memory(u32 addr, u32 size);
+
+		// Record the memory used by the current draw call
+		void record_draw(thread& rsx);
+
+		// Stop recording and write the capture
+		void finish(const std::string& path);
+	};
+}
@@ -4,13 +4,11 @@
 #include "RSXThread.h"
 #include "Emu/Memory/Memory.h"
 #include "Emu/System.h"
+#include "Emu/Benchmark.h"
 #include "rsx_utils.h"
 #include "rsx_decode.h"
 #include "Emu/Cell/PPUCallback.h"
 
-#include <sstream>
-#include <cereal/archives/binary.hpp>
-
 #include <thread>
 
 cfg::map_entry<double> g_cfg_rsx_frame_limit(cfg::root.video, "Frame limit",
@@ -115,6 +113,11 @@ namespace rsx
 
 			auto& info = rsx::method_registers.register_vertex_info[attribute_index];
 
+			if (info.type != vertex_data_type_from_element_type<type>::type || info.size != count || info.frequency != 0)
+			{
+				rsx->m_vertex_program_dirty = true;
+			}
+
 			info.type = vertex_data_type_from_element_type<type>::type;
 			info.size = count;
 			info.frequency = 0;
@@ -229,6 +232,7 @@ namespace rsx
 			static void impl(thread* rsx, u32 _reg, u32 arg)
 			{
 				method_registers.commit_4_transform_program_instructions(index);
+				rsx->m_vertex_program_dirty = true;
 			}
 		};
 
@@ -254,7 +258,11 @@ namespace rsx
 					u32 element_size = rsx::get_vertex_type_size_on_host(vertex_info.type, vertex_info.size);
 					u32 element_count = vertex_info.size;
 
-					vertex_info.frequency = element_count;
+					if (vertex_info.frequency != element_count)
+					{
+						vertex_info.frequency = element_count;
+						rsxthr->m_vertex_program_dirty = true;
+					}
 
 					if (rsx::method_registers.current_draw_clause.command == rsx::draw_command::none)
 					{
@@ -335,6 +343,9 @@ namespace rsx
 		void set_surface_dirty_bit(thread* rsx, u32 _reg, u32)
 		{
 			rsx->m_rtts_dirty = true;
+
+			// Backends may redirect texture sampling to render targets
+			rsx->m_fragment_program_dirty = true;
 		}
 
 		template<u32 index>
@@ -343,6 +354,32 @@ namespace rsx
 			static void impl(thread* rsx, u32 _reg, u32 arg)
 			{
 				rsx->m_textures_dirty[index] = true;
+				rsx->m_fragment_program_dirty = true;
+			}
+		};
+
+		void set_vertex_program_dirty_bit(thread* rsx, u32 _reg, u32)
+		{
+			rsx->m_vertex_program_dirty = true;
+		}
+
+		void set_fragment_program_dirty_bit(thread* rsx, u32 _reg, u32)
+		{
+			rsx->m_fragment_program_dirty = true;
+		}
+
+		void set_vertex_attrib_output_mask(thread* rsx, u32 _reg, u32)
+		{
+			rsx->m_vertex_program_dirty = true;
+			rsx->m_fragment_program_dirty = true;
+		}
+
+		template<u32 index>
+		struct set_vertex_array_format
+		{
+			static void impl(thread* rsx, u32 _reg, u32 arg)
+			{
+				rsx->m_vertex_program_dirty = true;
 			}
 		};
 	}
@@ -734,22 +771,10 @@ namespace rsx
 
 	void flip_command(thread* rsx, u32, u32 arg)
 	{
-		if (user_asked_for_frame_capture)
-		{
-			rsx->capture_current_frame = true;
-			user_asked_for_frame_capture = false;
-			frame_debug.reset();
-		}
-		else if (rsx->capture_current_frame)
+		if (rsx->capture_current_frame)
 		{
 			rsx->capture_current_frame = false;
-			std::stringstream os;
-			cereal::BinaryOutputArchive archive(os);
-			archive(frame_debug);
-			{
-				fs::file f(fs::get_config_dir() + "capture.txt", fs::rewrite);
-				f.write(os.str());
-			}
+			rsx->m_frame_recorder.finish(fs::get_config_dir() + "capture_" + (Emu.GetTitleID().empty() ? "unknown" : Emu.GetTitleID()) + ".rrc");
 			Emu.Pause();
 		}
 
@@ -762,11 +787,22 @@ namespace rsx
 		}
 		
 		rsx->gcm_current_buffer = arg;
+		rsx->get_upload_cache().on_flip();
 		rsx->flip(arg);
+		g_perf_counters.rsx_flips++;
 		// After each flip PS3 system is executing a routine that changes registers value to some default.
 		// Some game use this default state (SH3).
 		rsx->reset();
 
+		if (user_asked_for_frame_capture)
+		{
+			// Capture the next frame, starting from the state set after the flip
+			rsx->capture_current_frame = true;
+			user_asked_for_frame_capture = false;
+			frame_debug.reset();
+			rsx->m_frame_recorder.start(*rsx);
+		}
+
 		rsx->last_flip_time = get_system_time() - 1000000;
 		rsx->gcm_current_buffer = arg;
 		rsx->flip_status = 0;
@@ -1298,6 +1334,17 @@ namespace rsx
 		bind_range<NV4097_SET_TEXTURE_FILTER, 8, 16, nv4097::set_texture_dirty_bit>();
 		bind_range<NV4097_SET_TEXTURE_IMAGE_RECT, 8, 16, nv4097::set_texture_dirty_bit>();
 		bind_range<NV4097_SET_TEXTURE_BORDER_COLOR, 8, 16, nv4097::set_texture_dirty_bit>();
+		bind<NV4097_SET_TRANSFORM_PROGRAM_START, nv4097::set_vertex_program_dirty_bit>();
+		bind<NV4097_SET_VERTEX_ATTRIB_INPUT_MASK, nv4097::set_vertex_program_dirty_bit>();
+		bind<NV4097_SET_FREQUENCY_DIVIDER_OPERATION, nv4097::set_vertex_program_dirty_bit>();
+		bind_range<NV4097_SET_VERTEX_DATA_ARRAY_FORMAT, 1, 16, nv4097::set_vertex_array_format>();
+		bind<NV4097_SET_VERTEX_ATTRIB_OUTPUT_MASK, nv4097::set_vertex_attrib_output_mask>();
+		bind<NV4097_SET_SHADER_PROGRAM, nv4097::set_fragment_program_dirty_bit>();
+		bind<NV4097_SET_SHADER_CONTROL, nv4097::set_fragment_program_dirty_bit>();
+		bind<NV4097_SET_SHADER_WINDOW, nv4097::set_fragment_program_dirty_bit>();
+		bind<NV4097_SET_TWO_SIDE_LIGHT_EN, nv4097::set_fragment_program_dirty_bit>();
+		bind<NV4097_SET_ALPHA_FUNC, nv4097::set_fragment_program_dirty_bit>();
+		bind<NV4097_SET_FOG_MODE, nv4097::set_fragment_program_dirty_bit>();
 
 		//NV308A
 		bind_range<NV308A_COLOR, 1, 256, nv308a::color>();
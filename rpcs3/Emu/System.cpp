@@ -5,6 +5,7 @@
 #include "Emu/Memory/Memory.h"
 #include "Emu/System.h"
 
+#include "Emu/CPU/CPUProfiler.h"
 #include "Emu/Cell/PPUThread.h"
 #include "Emu/Cell/PPUCallback.h"
 #include "Emu/Cell/PPUOpcodes.h"
@@ -14,6 +15,7 @@
 #include "Emu/PSP2/ARMv7Thread.h"
 
 #include "Emu/IdManager.h"
+#include "Emu/Benchmark.h"
 #include "Emu/RSX/GSRender.h"
 
 #include "Loader/PSF.h"
@@ -159,12 +161,21 @@ void Emulator::Load()
 
 		const std::string& elf_dir = fs::get_parent_dir(m_path);
 
+		// Decrypted in memory (the decrypted file is not written)
+		const fs::file elf_file = decrypt_self(fs::file(m_path));
+
 		if (IsSelf(m_path))
 		{
+			// The name of the decrypted file is still used for the custom config
 			const std::size_t elf_ext_pos = m_path.find_last_of('.');
 			const std::string& elf_ext = fmt::to_upper(m_path.substr(elf_ext_pos != -1 ? elf_ext_pos : m_path.size()));
 			const std::string& elf_name = m_path.substr(elf_dir.size());
 
+			if (m_elf_path.empty())
+			{
+				m_elf_path = "/host_root/" + m_path;
+			}
+
 			if (elf_name.compare(elf_name.find_last_of("/\\", -1, 2) + 1, 9, "EBOOT.BIN", 9) == 0)
 			{
 				m_path.erase(m_path.size() - 9, 1); // change EBOOT.BIN to BOOT.BIN
@@ -178,7 +189,7 @@ void Emulator::Load()
 				m_path += ".decrypted.elf";
 			}
 
-			if (!DecryptSelf(m_path, elf_dir + elf_name))
+			if (!elf_file)
 			{
 				LOG_ERROR(LOADER, "Failed to decrypt %s", elf_dir + elf_name);
 				return;
@@ -196,7 +207,6 @@ void Emulator::Load()
 			cfg::root.from_string(cfg_file.to_string());
 		}
 
-		const fs::file elf_file(m_path);
 		ppu_exec_object ppu_exec;
 		ppu_prx_object ppu_prx;
 		spu_exec_object spu_exec;
@@ -300,6 +310,16 @@ void Emulator::Load()
 			vm::psv::init();
 			arm_load_exec(arm_exec);
 		}
+		else if (const auto capture = rsx::frame_capture::load(elf_file))
+		{
+			// RSX frame capture (replayed without guest code)
+			g_system = system_type::ps3;
+			m_status = Ready;
+			vm::ps3::init();
+			m_title = m_path;
+			m_title_id = capture->title_id;
+			rsx::frame_capture::start_replay(capture);
+		}
 		else
 		{
 			LOG_ERROR(LOADER, "Invalid or unsupported file format: %s", m_path);
@@ -428,6 +448,9 @@ void Emulator::Stop()
 
 	LOG_NOTICE(GENERAL, "Stopping emulator...");
 
+	// Write profiler results while guest objects still exist
+	cpu_profiler::stop();
+
 	rpcs3::on_stop()();
 	SendDbgCommand(DID_STOP_EMU);
 
@@ -455,6 +478,13 @@ void Emulator::Stop()
 
 	LOG_NOTICE(GENERAL, "All threads stopped...");
 
+	if (g_perf_counters.enabled)
+	{
+		LOG_NOTICE(GENERAL, "Access violations: reservation=%llu, texture cache=%llu, upload cache=%llu, RawSPU MMIO=%llu (RawSPU MMIO without access violation: %llu)",
+			g_perf_counters.fault_reservation.load(), g_perf_counters.fault_rsx_texture.load(), g_perf_counters.fault_rsx_upload.load(),
+			g_perf_counters.fault_raw_spu.load(), g_perf_counters.raw_spu_mmio.load());
+	}
+
 	idm::clear();
 	fxm::clear();
 
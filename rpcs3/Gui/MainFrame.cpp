@@ -5,6 +5,7 @@
 
 #include "Emu/Memory/Memory.h"
 #include "Emu/System.h"
+#include "Emu/CPU/CPUProfiler.h"
 #include "Gui/PADManager.h"
 #include "Gui/AboutDialog.h"
 #include "Gui/GameViewer.h"
@@ -54,6 +55,7 @@ enum IDs
 	id_tools_memory_viewer,
 	id_tools_rsx_debugger,
 	id_tools_string_search,
+	id_tools_profiler,
 	id_tools_decrypt_sprx_libraries,
 	id_tools_cg_disasm,
 	id_help_about,
@@ -112,6 +114,7 @@ MainFrame::MainFrame()
 	menu_tools->Append(id_tools_memory_viewer, "&Memory Viewer")->Enable(false);
 	menu_tools->Append(id_tools_rsx_debugger, "&RSX Debugger")->Enable(false);
 	menu_tools->Append(id_tools_string_search, "&String Search")->Enable(false);
+	menu_tools->AppendCheckItem(id_tools_profiler, "Guest &Profiler")->Enable(false);
 	menu_tools->AppendSeparator();
 	menu_tools->Append(id_tools_decrypt_sprx_libraries, "&Decrypt SPRX libraries");
 
@@ -155,6 +158,7 @@ MainFrame::MainFrame()
 	Bind(wxEVT_MENU, &MainFrame::OpenMemoryViewer, this, id_tools_memory_viewer);
 	Bind(wxEVT_MENU, &MainFrame::OpenRSXDebugger, this, id_tools_rsx_debugger);
 	Bind(wxEVT_MENU, &MainFrame::OpenStringSearch, this, id_tools_string_search);
+	Bind(wxEVT_MENU, &MainFrame::ToggleProfiler, this, id_tools_profiler);
 	Bind(wxEVT_MENU, &MainFrame::OpenCgDisasm, this, id_tools_cg_disasm);
 
 	Bind(wxEVT_MENU, &MainFrame::AboutDialogHandler, this, id_help_about);
@@ -484,6 +488,14 @@ void MainFrame::OpenStringSearch(wxCommandEvent& WXUNUSED(event))
 	(new MemoryStringSearcher(this))->Show();
 }
 
+void MainFrame::ToggleProfiler(wxCommandEvent& event)
+{
+	if (event.IsChecked() ? !cpu_profiler::start() : !cpu_profiler::stop())
+	{
+		LOG_ERROR(GENERAL, "Failed to %s the profiler", event.IsChecked() ? "start" : "stop");
+	}
+}
+
 void MainFrame::OpenCgDisasm(wxCommandEvent& WXUNUSED(event))
 {
 	(new CgDisasm(this))->Show();
@@ -579,10 +591,13 @@ void MainFrame::UpdateUI(wxCommandEvent& event)
 	wxMenuItem& memory_viewer = *menubar.FindItem(id_tools_memory_viewer);
 	wxMenuItem& rsx_debugger = *menubar.FindItem(id_tools_rsx_debugger);
 	wxMenuItem& string_search = *menubar.FindItem(id_tools_string_search);
+	wxMenuItem& profiler = *menubar.FindItem(id_tools_profiler);
 	kernel_explorer.Enable(!is_stopped);
 	memory_viewer.Enable(!is_stopped);
 	rsx_debugger.Enable(!is_stopped);
 	string_search.Enable(!is_stopped);
+	profiler.Enable(!is_stopped);
+	profiler.Check(cpu_profiler::is_running());
 }
 
 void MainFrame::OnQuit(wxCloseEvent& event)
@@ -43,6 +43,7 @@ private:
 	void OpenMemoryViewer(wxCommandEvent& evt);
 	void OpenRSXDebugger(wxCommandEvent& evt);
 	void OpenStringSearch(wxCommandEvent& evt);
+	void ToggleProfiler(wxCommandEvent& evt);
 	void OpenCgDisasm(wxCommandEvent& evt);
 	void DecryptSPRXLibraries(wxCommandEvent& event);
 	void AboutDialogHandler(wxCommandEvent& event);
@@ -5,6 +5,8 @@
 #include "Utilities/Config.h"
 #include "Emu/Memory/Memory.h"
 #include "Emu/System.h"
+#include "Emu/IdManager.h"
+#include "Emu/Benchmark.h"
 
 #include "Gui/ConLogFrame.h"
 #include "Emu/GameInfo.h"
@@ -114,12 +116,18 @@ cfg::map_entry<std::function<std::shared_ptr<AudioThread>()>> g_cfg_audio_render
 extern cfg::bool_entry g_cfg_autostart;
 extern cfg::bool_entry g_cfg_autoexit;
 
+// Benchmark mode: null renderer and input, no main window, results written on exit
+static bool s_benchmark = false;
+
 bool Rpcs3App::OnInit()
 {
 	static const wxCmdLineEntryDesc desc[]
 	{
 		{ wxCMD_LINE_SWITCH, "h", "help", "Command line options:\nh (help): Help and commands\nt (test): For directly executing a (S)ELF", wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
 		{ wxCMD_LINE_SWITCH, "t", "test", "Run in test mode on (S)ELF", wxCMD_LINE_VAL_NONE },
+		{ wxCMD_LINE_OPTION, NULL, "bench", "Run the (S)ELF headless for the specified amount of seconds and write the statistics", wxCMD_LINE_VAL_NUMBER },
+		{ wxCMD_LINE_OPTION, NULL, "bench-frames", "Stop the benchmark after the specified amount of frames", wxCMD_LINE_VAL_NUMBER },
+		{ wxCMD_LINE_OPTION, NULL, "bench-output", "Benchmark results file (JSON)", wxCMD_LINE_VAL_STRING },
 		{ wxCMD_LINE_PARAM, NULL, NULL, "(S)ELF", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL },
 		{ wxCMD_LINE_NONE }
 	};
@@ -133,6 +141,11 @@ bool Rpcs3App::OnInit()
 		this->Exit();
 	}
 
+	s_benchmark = parser.Found("bench") || parser.Found("bench-frames");
+
+	// Enable hot path counters (must be set before the emulation starts)
+	g_perf_counters.enabled = s_benchmark;
+
 	s_gui_cfg.open(fs::get_config_dir() + "/config_gui.yml", fs::read + fs::write + fs::create);
 	g_gui_cfg = YAML::Load(s_gui_cfg.to_string());
 
@@ -159,11 +172,20 @@ bool Rpcs3App::OnInit()
 		wxGetApp().SendDbgCommand(id, t);
 	};
 
-	callbacks.get_kb_handler = []{ return g_cfg_kb_handler.get()(); };
+	callbacks.get_kb_handler = []() -> std::shared_ptr<KeyboardHandlerBase>
+	{
+		return s_benchmark ? std::make_shared<NullKeyboardHandler>() : g_cfg_kb_handler.get()();
+	};
 
-	callbacks.get_mouse_handler = []{ return g_cfg_mouse_handler.get()(); };
+	callbacks.get_mouse_handler = []() -> std::shared_ptr<MouseHandlerBase>
+	{
+		return s_benchmark ? std::make_shared<NullMouseHandler>() : g_cfg_mouse_handler.get()();
+	};
 
-	callbacks.get_pad_handler = []{ return g_cfg_pad_handler.get()(); };
+	callbacks.get_pad_handler = []() -> std::shared_ptr<PadHandlerBase>
+	{
+		return s_benchmark ? std::make_shared<NullPadHandler>() : g_cfg_pad_handler.get()();
+	};
 
 	callbacks.get_gs_frame = [](frame_type type, int w, int h) -> std::unique_ptr<GSFrameBase>
 	{
@@ -178,9 +200,15 @@ bool Rpcs3App::OnInit()
 		fmt::throw_exception("Invalid frame type (0x%x)" HERE, (int)type);
 	};
 
-	callbacks.get_gs_render = []{ return g_cfg_gs_render.get()(); };
+	callbacks.get_gs_render = []() -> std::shared_ptr<GSRender>
+	{
+		return s_benchmark ? std::make_shared<NullGSRender>() : g_cfg_gs_render.get()();
+	};
 
-	callbacks.get_audio = []{ return g_cfg_audio_render.get()(); };
+	callbacks.get_audio = []() -> std::shared_ptr<AudioThread>
+	{
+		return s_benchmark ? std::make_shared<NullAudioThread>() : g_cfg_audio_render.get()();
+	};
 
 	callbacks.get_msg_dialog = []() -> std::shared_ptr<MsgDialogBase>
 	{
@@ -202,7 +230,12 @@ bool Rpcs3App::OnInit()
 
 	m_MainFrame = new MainFrame();
 	SetTopWindow(m_MainFrame);
-	m_MainFrame->Show();
+
+	if (!s_benchmark)
+	{
+		m_MainFrame->Show();
+	}
+
 	m_MainFrame->DoSettings(true);
 
 	OnArguments(parser);
@@ -215,6 +248,9 @@ void Rpcs3App::OnArguments(const wxCmdLineParser& parser)
 	// Usage:
 	//   rpcs3-*.exe               Initializes RPCS3
 	//   rpcs3-*.exe [(S)ELF]      Initializes RPCS3, then loads and runs the specified (S)ELF file.
+	//   rpcs3-*.exe --bench=<seconds> [--bench-frames=<frames>] [--bench-output=<file>] (S)ELF
+	//                             Runs the (S)ELF headless until one of the limits is reached, writes the statistics and exits.
+	// An RSX frame capture (.rrc) can be given instead of the (S)ELF, the captured frame is replayed in a loop.
 
 	if (parser.FoundSwitch("t"))
 	{
@@ -228,6 +264,18 @@ void Rpcs3App::OnArguments(const wxCmdLineParser& parser)
 		g_cfg_autostart = true;
 		g_cfg_autoexit = true;
 	}
+
+	if (s_benchmark)
+	{
+		if (parser.GetParamCount() != 1)
+		{
+			wxLogDebug("A (S)ELF file needs to be given in benchmark mode, exiting.");
+			this->Exit();
+		}
+
+		g_cfg_autostart = true;
+		g_cfg_autoexit = true;
+	}
 	
 	if (parser.GetParamCount() > 0)
 	{
@@ -235,6 +283,19 @@ void Rpcs3App::OnArguments(const wxCmdLineParser& parser)
 		Emu.Load();
 		Emu.Run();
 	}
+
+	if (s_benchmark && !Emu.IsStopped())
+	{
+		long seconds = 0, frames = 0;
+		wxString output;
+
+		parser.Found("bench", &seconds);
+		parser.Found("bench-frames", &frames);
+
+		const std::string path = parser.Found("bench-output", &output) ? fmt::ToUTF8(output) : fs::get_config_dir() + "benchmark.json";
+
+		fxm::make<benchmark_thread>(std::max<long>(seconds, 0) * 1000000ull, std::max<long>(frames, 0), path);
+	}
 }
 
 void Rpcs3App::Exit()